@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    ControlConnection.h
+    TCP link to the local console on port 9002, opened in the background.
+
+    Connecting can block for seconds when nothing listens, which used to hold
+    up the plugin constructor and with it every plugin scan and session load.
+    A thread of its own now connects once playback is prepared, sends the
+    greeting and tries again every few seconds until the console answers.
+    It connects in short attempts, so the destructor on the message thread
+    waits at most one of them for the thread to stop, not the whole timeout.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class ControlConnection  : private juce::Thread
+{
+public:
+    static constexpr int port = 9002;
+    static constexpr int timeoutMs = 3000;
+    static constexpr int attemptMs = 200;
+    static constexpr int retryMs = 5000;
+
+    enum class State { idle, connecting, connected, failed };
+
+    ControlConnection() : juce::Thread ("ControlConnection") {}
+    ~ControlConnection() override { stopThread (attemptMs + 1000); }
+
+    // any thread, does nothing while the worker runs or once connected
+    void start()
+    {
+        if (state != State::connected)
+            startThread (juce::Thread::Priority::low);
+    }
+
+    State getState() const { return state; }
+
+    // "connected", "connecting...", ... for the editor
+    juce::String getStatus() const
+    {
+        switch (state.load())
+        {
+            case State::idle:       return "not opened until playback starts";
+            case State::connecting: return "connecting to :" + juce::String (port) + "...";
+            case State::connected:  return "connected to :" + juce::String (port);
+            case State::failed:     return "no console on :" + juce::String (port) + ", retrying";
+        }
+        return {};
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            state = State::connecting;
+            if (connect())
+            {
+                static constexpr char greeting[] = "test";
+                socket.write (greeting, (int) sizeof (greeting) - 1);
+                state = State::connected;
+                return;
+            }
+
+            state = State::failed;
+            wait (retryMs);
+        }
+    }
+
+    // gives up after timeoutMs like a single connect would, but checks for
+    // the destructor between attempts of attemptMs
+    bool connect()
+    {
+        const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+        while (! threadShouldExit())
+        {
+            const auto started = juce::Time::getMillisecondCounter();
+            if (socket.connect ("127.0.0.1", port, attemptMs))
+                return true;
+
+            // refused rather than timed out, nothing listens on the port
+            const auto now = juce::Time::getMillisecondCounter();
+            if (now - started < (juce::uint32) attemptMs / 2 || now >= deadline)
+                return false;
+        }
+        return false;
+    }
+
+    // stays open as long as the plugin once connected, like before
+    juce::StreamingSocket socket;
+    std::atomic<State> state { State::idle };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControlConnection)
+};
@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    JitterBuffer.h
+    Single producer / single consumer audio FIFO for one received stream.
+
+    The network thread pushes whole datagrams, the audio thread pops blocks.
+    After a start or an underrun the buffer waits until `target` frames are
+    queued again before it plays, which absorbs the network jitter.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StreamPacket.h"
+
+class JitterBuffer
+{
+public:
+    // over a second at 48 kHz, allocated once so the network
+    // thread never races an allocation
+    static constexpr int capacity = 1 << 16;
+
+    JitterBuffer()
+        : fifo (capacity), storage (StreamPacket::maxChannels, capacity)
+    {
+        storage.clear();
+    }
+
+    // only call while neither the network thread nor the audio thread use it
+    void prepare (int targetFrames)
+    {
+        fifo.reset();
+        target = juce::jlimit (0, capacity / 2, targetFrames);
+        priming = true;
+        underruns = 0;
+        overruns = 0;
+        lost = 0;
+        expectedSequence = 0;
+        hasSequence = false;
+    }
+
+    //==============================================================================
+    // network thread
+    void push (const StreamPacket::View& packet)
+    {
+        if (packet.hasSequence)
+        {
+            // signed, so the distance survives the sequence wrapping around
+            const auto distance = (juce::int32) (packet.sequence - expectedSequence);
+            if (hasSequence)
+            {
+                // late or repeated, its gap was counted and its time has been played.
+                // Further back than that the sender restarted and is followed
+                if (distance < 0 && distance >= -restartDistance)
+                    return;
+                if (distance > 0)
+                    lost += distance;
+            }
+            expectedSequence = packet.sequence + 1;
+            hasSequence = true;
+        }
+        if (packet.sampleRate > 0)
+            sampleRate = packet.sampleRate;
+        numChannels = packet.numChannels;
+
+        if (fifo.getFreeSpace() < packet.numFrames)
+        {
+            ++overruns;
+            return;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (packet.numFrames, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < StreamPacket::maxChannels; ++ch)
+        {
+            // mono streams fill both channels so any bus width can play them
+            const int srcCh = juce::jmin (ch, packet.numChannels - 1);
+            deinterleave (packet, srcCh, 0, storage.getWritePointer (ch, start1), size1);
+            deinterleave (packet, srcCh, size1, storage.getWritePointer (ch, start2), size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+    }
+
+    //==============================================================================
+    // audio thread
+    void pop (float* const* dest, int numDestChannels, int numFrames)
+    {
+        const int ready = fifo.getNumReady();
+
+        if (priming)
+        {
+            if (ready < juce::jmax (target, numFrames))
+            {
+                clear (dest, numDestChannels, 0, numFrames);
+                return;
+            }
+            priming = false;
+        }
+
+        const int toRead = juce::jmin (ready, numFrames);
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (toRead, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < numDestChannels; ++ch)
+        {
+            const int srcCh = juce::jmin (ch, StreamPacket::maxChannels - 1);
+            juce::FloatVectorOperations::copy (dest[ch], storage.getReadPointer (srcCh, start1), size1);
+            if (size2 > 0)
+                juce::FloatVectorOperations::copy (dest[ch] + size1, storage.getReadPointer (srcCh, start2), size2);
+        }
+
+        fifo.finishedRead (size1 + size2);
+
+        if (toRead < numFrames)
+        {
+            clear (dest, numDestChannels, toRead, numFrames - toRead);
+            ++underruns;
+            priming = true;
+        }
+    }
+
+    //==============================================================================
+    int getNumReady() const         { return fifo.getNumReady(); }
+    int getTarget() const           { return target; }
+    int getSampleRate() const       { return sampleRate; }
+    int getNumChannels() const      { return numChannels; }
+    int getUnderruns() const        { return underruns; }
+    int getOverruns() const         { return overruns; }
+    int getLost() const             { return lost; }
+
+private:
+    static void deinterleave (const StreamPacket::View& packet, int channel, int offset, float* dest, int numFrames)
+    {
+        const float* src = packet.samples + offset * packet.numChannels + channel;
+        for (int i = 0; i < numFrames; ++i)
+            dest[i] = src[i * packet.numChannels];
+    }
+
+    static void clear (float* const* dest, int numDestChannels, int offset, int numFrames)
+    {
+        for (int ch = 0; ch < numDestChannels; ++ch)
+            juce::FloatVectorOperations::clear (dest[ch] + offset, numFrames);
+    }
+
+    juce::AbstractFifo fifo;
+    juce::AudioBuffer<float> storage;
+    int target = 0;
+    bool priming = true;
+
+    // written by one thread and only read for display by the others
+    std::atomic<int> sampleRate { 0 };
+    std::atomic<int> numChannels { 1 };
+    std::atomic<int> underruns { 0 };
+    std::atomic<int> overruns { 0 };
+    std::atomic<int> lost { 0 };
+
+    // network thread only
+    static constexpr juce::int32 restartDistance = 1024;
+    juce::uint32 expectedSequence = 0;
+    bool hasSequence = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (JitterBuffer)
+};
@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    LatencyFeed.h
+    Publishes the playout delay of a stream to the Compensator over OSC.
+
+    A small thread sends "/vibeio/latency/<feed> ,f <seconds>" to the
+    Compensator's OSC port on this machine every few milliseconds. Every
+    receiver instance uses its own feed id, and the Compensator follows the
+    one it was told to, so several receivers on one machine do not mix. The value is only the
+    part of the path this side can see (jitter buffer plus resampler), the
+    Compensator applies the changes of it on top of its measured delay, so
+    the unknown network part does not matter as long as it holds still.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "StreamPlayer.h"
+
+class LatencyFeed  : private juce::Thread
+{
+public:
+    // the Compensator's OscControl::kiPort
+    static constexpr int port = 9001;
+    static constexpr int intervalMs = 20;
+    // the Compensator's kiMaxFeeds
+    static constexpr int maxFeedId = 16;
+
+    LatencyFeed() : juce::Thread ("LatencyFeed") {}
+    ~LatencyFeed() override { stop(); }
+
+    // the player must outlive the feed or the next stop()
+    void start (const StreamPlayer& streamPlayer)
+    {
+        stop();
+        player = &streamPlayer;
+        startThread();
+    }
+
+    void stop() { stopThread (1000); }
+
+    // any thread, 1 .. maxFeedId, takes effect with the next report
+    void setFeedId (int newFeedId)  { feedId = juce::jlimit (1, maxFeedId, newFeedId); }
+    int getFeedId() const           { return feedId; }
+
+private:
+    // "/vibeio/latency/1" to "/vibeio/latency/16" and ",f" both pad to four bytes
+    static constexpr int addressSize = 20;
+    static constexpr int headerSize = addressSize + 4;
+    static constexpr int messageSize = headerSize + 4;
+
+    void run() override
+    {
+        juce::DatagramSocket socket;
+        char message[messageSize];
+        int messageFeedId = 0;
+
+        while (! threadShouldExit())
+        {
+            if (messageFeedId != feedId)
+            {
+                messageFeedId = feedId;
+                std::memset (message, 0, headerSize);
+                const auto address = "/vibeio/latency/" + juce::String (messageFeedId);
+                address.copyToUTF8 (message, addressSize);
+                std::memcpy (message + addressSize, ",f", 2);
+            }
+
+            // nothing is queued before the first block
+            const float seconds = (float) player->getPlayoutDelaySeconds();
+            if (seconds > 0.0f)
+            {
+                juce::uint32 bits;
+                std::memcpy (&bits, &seconds, sizeof (bits));
+                bits = juce::ByteOrder::swapIfLittleEndian (bits);
+                std::memcpy (message + headerSize, &bits, sizeof (bits));
+                socket.write ("127.0.0.1", port, message, messageSize);
+            }
+
+            wait (intervalMs);
+        }
+    }
+
+    const StreamPlayer* player = nullptr;
+    std::atomic<int> feedId { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyFeed)
+};
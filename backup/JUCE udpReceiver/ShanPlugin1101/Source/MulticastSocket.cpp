@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    MulticastSocket.cpp
+
+  ==============================================================================
+*/
+
+#include "MulticastSocket.h"
+
+#if JUCE_WINDOWS
+ #include <winsock2.h>
+ #include <ws2tcpip.h>
+ #include <netioapi.h>
+ #pragma comment (lib, "ws2_32.lib")
+ #pragma comment (lib, "iphlpapi.lib")
+ using NativeSocket = SOCKET;
+ using SockOpt = const char*;
+ static void closeNative (NativeSocket s)  { closesocket (s); }
+#else
+ #include <arpa/inet.h>
+ #include <net/if.h>
+ #include <netdb.h>
+ #include <netinet/in.h>
+ #include <poll.h>
+ #include <sys/socket.h>
+ #include <unistd.h>
+ using NativeSocket = int;
+ using SockOpt = const void*;
+ static void closeNative (NativeSocket s)  { ::close (s); }
+#endif
+
+namespace
+{
+    bool parseAddress (const juce::String& text, int family, sockaddr_storage& result)
+    {
+        addrinfo hints {};
+        hints.ai_family = family;
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_flags = AI_NUMERICHOST;
+
+        addrinfo* info = nullptr;
+        if (getaddrinfo (text.toRawUTF8(), nullptr, &hints, &info) != 0 || info == nullptr)
+            return false;
+
+        std::memset (&result, 0, sizeof (result));
+        std::memcpy (&result, info->ai_addr, (size_t) info->ai_addrlen);
+        freeaddrinfo (info);
+        return true;
+    }
+
+    unsigned int interfaceIndex (const juce::String& name)
+    {
+        if (name.isEmpty())
+            return 0;
+        if (name.containsOnly ("0123456789"))
+            return (unsigned int) name.getIntValue();
+        return if_nametoindex (name.toRawUTF8());
+    }
+
+    template <typename Value>
+    bool setOption (NativeSocket s, int level, int option, const Value& value)
+    {
+        return setsockopt (s, level, option, (SockOpt) &value, (socklen_t) sizeof (value)) == 0;
+    }
+}
+
+MulticastSocket::~MulticastSocket()
+{
+    close();
+}
+
+bool MulticastSocket::open (int port, const Membership& membership, juce::String& error)
+{
+    close();
+
+   #if JUCE_WINDOWS
+    WSADATA wsa;
+    WSAStartup (MAKEWORD (2, 2), &wsa);
+   #endif
+
+    // the group decides the address family, unicast stays on IPv4 like the sender
+    sockaddr_storage group {};
+    int family = AF_INET;
+    if (membership.group.isNotEmpty())
+    {
+        if (parseAddress (membership.group, AF_INET, group))
+            family = AF_INET;
+        else if (parseAddress (membership.group, AF_INET6, group))
+            family = AF_INET6;
+        else
+        {
+            error = "not a multicast address: " + membership.group;
+            return false;
+        }
+    }
+
+    sockaddr_storage source {};
+    if (membership.source.isNotEmpty() && ! parseAddress (membership.source, family, source))
+    {
+        error = "source " + membership.source + " is not in the group's address family";
+        return false;
+    }
+
+    const unsigned int ifIndex = interfaceIndex (membership.interfaceName);
+    if (membership.interfaceName.isNotEmpty() && ifIndex == 0)
+    {
+        error = "unknown interface " + membership.interfaceName;
+        return false;
+    }
+
+    const NativeSocket s = socket (family, SOCK_DGRAM, IPPROTO_UDP);
+   #if JUCE_WINDOWS
+    if (s == INVALID_SOCKET)
+   #else
+    if (s < 0)
+   #endif
+    {
+        error = "could not create a socket";
+        return false;
+    }
+
+    // every receiver on this machine binds the same port and gets its own copy of the group's packets
+    if (membership.group.isNotEmpty())
+    {
+        setOption (s, SOL_SOCKET, SO_REUSEADDR, 1);
+       #ifdef SO_REUSEPORT
+        setOption (s, SOL_SOCKET, SO_REUSEPORT, 1);
+       #endif
+    }
+
+    sockaddr_storage local {};
+    socklen_t localSize;
+    if (family == AF_INET6)
+    {
+        setOption (s, IPPROTO_IPV6, IPV6_V6ONLY, 1);
+        auto* addr = reinterpret_cast<sockaddr_in6*> (&local);
+        addr->sin6_family = AF_INET6;
+        addr->sin6_addr = in6addr_any;
+        addr->sin6_port = htons ((uint16_t) port);
+        localSize = sizeof (sockaddr_in6);
+    }
+    else
+    {
+        auto* addr = reinterpret_cast<sockaddr_in*> (&local);
+        addr->sin_family = AF_INET;
+        addr->sin_addr.s_addr = htonl (INADDR_ANY);
+        addr->sin_port = htons ((uint16_t) port);
+        localSize = sizeof (sockaddr_in);
+    }
+
+    if (bind (s, reinterpret_cast<sockaddr*> (&local), localSize) != 0)
+    {
+        closeNative (s);
+        error = "could not bind UDP port " + juce::String (port);
+        return false;
+    }
+
+    if (membership.group.isNotEmpty())
+    {
+        // the protocol independent joins (RFC 3678) cover both families and SSM
+        const int level = family == AF_INET6 ? IPPROTO_IPV6 : IPPROTO_IP;
+        bool joined;
+
+        if (membership.source.isNotEmpty())
+        {
+            group_source_req request {};
+            request.gsr_interface = ifIndex;
+            std::memcpy (&request.gsr_group, &group, sizeof (group));
+            std::memcpy (&request.gsr_source, &source, sizeof (source));
+            joined = setOption (s, level, MCAST_JOIN_SOURCE_GROUP, request);
+        }
+        else
+        {
+            group_req request {};
+            request.gr_interface = ifIndex;
+            std::memcpy (&request.gr_group, &group, sizeof (group));
+            joined = setOption (s, level, MCAST_JOIN_GROUP, request);
+        }
+
+        if (! joined)
+        {
+            closeNative (s);
+            error = "could not join " + membership.group
+                      + (membership.source.isNotEmpty() ? " from " + membership.source : juce::String());
+            return false;
+        }
+    }
+
+    handle = (juce::int64) s;
+    boundPort = port;
+    sourceSpecific = membership.group.isNotEmpty() && membership.source.isNotEmpty();
+    return true;
+}
+
+void MulticastSocket::close()
+{
+    // closing the socket also leaves the group
+    if (handle >= 0)
+        closeNative ((NativeSocket) handle);
+
+    handle = -1;
+    boundPort = 0;
+    sourceSpecific = false;
+}
+
+int MulticastSocket::waitUntilReadable (int timeoutMs)
+{
+    if (handle < 0)
+        return -1;
+
+   #if JUCE_WINDOWS
+    WSAPOLLFD pfd { (NativeSocket) handle, POLLRDNORM, 0 };
+    const int result = WSAPoll (&pfd, 1, timeoutMs);
+   #else
+    pollfd pfd { (NativeSocket) handle, POLLIN, 0 };
+    const int result = poll (&pfd, 1, timeoutMs);
+   #endif
+
+    return result < 0 ? -1 : (result > 0 ? 1 : 0);
+}
+
+int MulticastSocket::read (void* dest, int maxBytes)
+{
+    if (handle < 0)
+        return -1;
+
+    return (int) recv ((NativeSocket) handle, static_cast<char*> (dest), maxBytes, 0);
+}
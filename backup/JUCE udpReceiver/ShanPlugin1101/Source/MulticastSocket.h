@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    MulticastSocket.h
+    Receive-only UDP socket that can also join an IPv4 or IPv6 multicast group.
+
+    juce::DatagramSocket only speaks IPv4 and has no source-specific joins, so
+    this wraps the native socket API directly. With a group configured, any
+    number of receivers (plugins on one machine or across the LAN) share one
+    stream from the sender: the port is bound with address reuse, and the join
+    is source specific when a source address is given (SSM, 232.0.0.0/8 and
+    ff3x::/32), any-source otherwise.
+
+    To try it on one machine, route the group through the loopback interface,
+    e.g. on Linux `ip route add 239.0.0.0/8 dev lo` and interface "lo".
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class MulticastSocket
+{
+public:
+    struct Membership
+    {
+        juce::String group;             // empty: plain unicast receive
+        juce::String source;            // empty: any-source multicast
+        juce::String interfaceName;     // empty: let the OS choose, else a name ("lo", "en0") or an index
+    };
+
+    MulticastSocket() = default;
+    ~MulticastSocket();
+
+    // binds the port for the group's address family and joins it, returns false with a reason on failure
+    bool open (int port, const Membership& membership, juce::String& error);
+    void close();
+
+    bool isOpen() const { return handle >= 0; }
+    int getBoundPort() const { return boundPort; }
+    bool isSourceSpecific() const { return sourceSpecific; }
+
+    // same semantics as juce::DatagramSocket::waitUntilReady (true, ...) and read()
+    int waitUntilReadable (int timeoutMs);
+    int read (void* dest, int maxBytes);
+
+private:
+    juce::int64 handle = -1;        // SOCKET on Windows, int elsewhere
+    int boundPort = 0;
+    bool sourceSpecific = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MulticastSocket)
+};
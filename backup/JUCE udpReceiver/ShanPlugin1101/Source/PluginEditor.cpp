@@ -15,7 +15,31 @@ ShanPlugin1101AudioProcessorEditor::ShanPlugin1101AudioProcessorEditor (ShanPlug
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
+    const auto membership = audioProcessor.getMulticastMembership();
+    const std::pair<juce::TextEditor*, juce::String> fields[] = {
+        { &groupEditor,     membership.group },
+        { &sourceEditor,    membership.source },
+        { &interfaceEditor, membership.interfaceName }
+    };
+    for (auto& [editor, text] : fields)
+    {
+        editor->setText (text, false);
+        editor->onReturnKey = [this] { applyMembership(); };
+        editor->onFocusLost = [this] { applyMembership(); };
+        addAndMakeVisible (editor);
+    }
+    groupEditor.setTextToShowWhenEmpty ("multicast group (unicast)", juce::Colours::grey);
+    sourceEditor.setTextToShowWhenEmpty ("source (any)", juce::Colours::grey);
+    interfaceEditor.setTextToShowWhenEmpty ("interface", juce::Colours::grey);
+
+    for (int id = 1; id <= LatencyFeed::maxFeedId; ++id)
+        feedBox.addItem ("feed " + juce::String (id), id);
+    feedBox.setSelectedId (audioProcessor.getLatencyFeedId(), juce::dontSendNotification);
+    feedBox.onChange = [this] { audioProcessor.setLatencyFeedId (feedBox.getSelectedId()); };
+    addAndMakeVisible (feedBox);
+
     setSize (400, 300);
+    startTimerHz (10);
 }
 
 ShanPlugin1101AudioProcessorEditor::~ShanPlugin1101AudioProcessorEditor()
@@ -30,16 +54,44 @@ void ShanPlugin1101AudioProcessorEditor::paint (juce::Graphics& g)
 
     g.setColour (juce::Colours::white);
     g.setFont (15.0f);
-    juce::String flag_connection = audioProcessor.flag_connection ? "true" : "false";
-    DBG("flag_connectio: " << flag_connection);
-    DBG("msg: " << audioProcessor.msg);
-    DBG("msg_num: " << audioProcessor.msg_num);
-    DBG("printing is right");
-    g.drawFittedText (flag_connection, getLocalBounds(), juce::Justification::centred, 1);
+    auto area = getLocalBounds().reduced (10);
+    g.drawFittedText ("console: " + audioProcessor.getControlConnection().getStatus(), area.removeFromTop (20).withTrimmedRight (94), juce::Justification::left, 1);
+    area.removeFromTop (24);    // group / source / interface editors
+    g.setFont (12.0f);
+    g.drawFittedText ("receiving: " + audioProcessor.getStreamReceiver().getStatus(), area.removeFromTop (18), juce::Justification::left, 1);
+
+    // one line per returned stream: queued / target frames and error counters
+    const auto& receiver = audioProcessor.getStreamReceiver();
+    for (int i = 0; i < StreamReceiver::maxStreams; ++i)
+    {
+        const auto& stream = receiver.getStream (i);
+        g.drawFittedText ("stream " + juce::String (i + 1)
+                            + "  " + juce::String (stream.getNumReady()) + "/" + juce::String (stream.getTarget())
+                            + "  underruns " + juce::String (stream.getUnderruns())
+                            + "  overruns " + juce::String (stream.getOverruns())
+                            + "  lost " + juce::String (stream.getLost()),
+                          area.removeFromTop (18), juce::Justification::left, 1);
+    }
 }
 
 void ShanPlugin1101AudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    feedBox.setBounds (getLocalBounds().reduced (10).removeFromTop (20).removeFromRight (90));
+    auto row = getLocalBounds().reduced (10).withTrimmedTop (20).removeFromTop (22);
+    groupEditor.setBounds (row.removeFromLeft (150).withTrimmedRight (4));
+    sourceEditor.setBounds (row.removeFromLeft (130).withTrimmedRight (4));
+    interfaceEditor.setBounds (row);
+}
+
+void ShanPlugin1101AudioProcessorEditor::applyMembership()
+{
+    MulticastSocket::Membership membership;
+    membership.group = groupEditor.getText().trim();
+    membership.source = sourceEditor.getText().trim();
+    membership.interfaceName = interfaceEditor.getText().trim();
+
+    const auto current = audioProcessor.getMulticastMembership();
+    if (membership.group != current.group || membership.source != current.source
+         || membership.interfaceName != current.interfaceName)
+        audioProcessor.setMulticastMembership (membership);
 }
@@ -14,7 +14,8 @@
 //==============================================================================
 /**
 */
-class ShanPlugin1101AudioProcessorEditor  : public juce::AudioProcessorEditor
+class ShanPlugin1101AudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                            private juce::Timer
 {
 public:
     ShanPlugin1101AudioProcessorEditor (ShanPlugin1101AudioProcessor&);
@@ -28,6 +29,15 @@ private:
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     ShanPlugin1101AudioProcessor& audioProcessor;
+    
+    void timerCallback() override { repaint(); }
+    void applyMembership();
+
+    // multicast group, optional SSM source and interface, empty group receives unicast
+    juce::TextEditor groupEditor, sourceEditor, interfaceEditor;
+    
+    // the Compensator's "Follow Feed" picks this instance by it
+    juce::ComboBox feedBox;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ShanPlugin1101AudioProcessorEditor)
 };
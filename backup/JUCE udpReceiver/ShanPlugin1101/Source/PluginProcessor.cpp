@@ -12,24 +12,28 @@
 //==============================================================================
 ShanPlugin1101AudioProcessor::ShanPlugin1101AudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
+     : AudioProcessor (createBusesProperties())
 #endif
 {
-    flag_connection = socket.connect("127.0.0.1", 9002, 3000);
-    int msg_len = strlen(msg);
-    msg_num = socket.write(msg, strlen(msg));
-    std::cout << "something" << std::endl;
 }
 
 ShanPlugin1101AudioProcessor::~ShanPlugin1101AudioProcessor()
 {
+    cancelPendingUpdate();
+}
+
+juce::AudioProcessor::BusesProperties ShanPlugin1101AudioProcessor::createBusesProperties()
+{
+    // the first returned stream plays on the main output, the others on
+    // auxiliary outputs the host can enable when it needs them
+    auto props = BusesProperties()
+                    .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                    .withOutput ("Stream 1", juce::AudioChannelSet::stereo(), true);
+
+    for (int i = 1; i < StreamReceiver::maxStreams; ++i)
+        props = props.withOutput ("Stream " + juce::String (i + 1), juce::AudioChannelSet::stereo(), false);
+
+    return props;
 }
 
 //==============================================================================
@@ -97,68 +101,109 @@ void ShanPlugin1101AudioProcessor::changeProgramName (int index, const juce::Str
 //==============================================================================
 void ShanPlugin1101AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
+    // queue two blocks plus 10 ms before each stream starts playing, counted
+    // in wire frames since that is what the jitter buffers hold
+    const int wireRate = streamReceiver.getStream (0).getSampleRate() > 0 ? streamReceiver.getStream (0).getSampleRate()
+                                                                          : StreamPlayer::defaultWireRate;
+    const int targetFrames = (int) ((2 * samplesPerBlock + sampleRate * 0.01) * wireRate / sampleRate);
+
+    for (int i = 0; i < StreamReceiver::maxStreams; ++i)
+    {
+        // a stream keeps the rate it declared last, unknown ones are assumed to be 48 kHz
+        const int streamRate = streamReceiver.getStream (i).getSampleRate();
+        streamPlayers[i].prepare (sampleRate, streamRate > 0 ? streamRate : wireRate, samplesPerBlock, targetFrames);
+    }
+
+    // never blocks, the console may take seconds to answer or not be running at all
+    controlConnection.start();
+
+    prepared = true;
+    if (! streamReceiver.start (StreamReceiver::defaultPort, targetFrames, getMulticastMembership()))
+        DBG ("could not open the stream socket: " << streamReceiver.getStatus());
+
+    setLatencySamples (streamPlayers[0].getLatencySamples());
+    latencyFeed.start (streamPlayers[0]);
+}
+
+void ShanPlugin1101AudioProcessor::handleAsyncUpdate()
+{
+    // a stream switched rates: its filter is designed here, the audio thread
+    // swaps it in and then asks once more so the new latency gets reported
+    for (auto& player : streamPlayers)
+        player.update();
+
+    setLatencySamples (streamPlayers[0].getLatencySamples());
 }
 
 void ShanPlugin1101AudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    prepared = false;
+    latencyFeed.stop();
+    streamReceiver.stop();
+}
+
+void ShanPlugin1101AudioProcessor::setMulticastMembership (const MulticastSocket::Membership& newMembership)
+{
+    {
+        const juce::ScopedLock sl (membershipLock);
+        membership = newMembership;
+    }
+
+    // stored until prepareToPlay otherwise. After a failed attempt, e.g. a
+    // mistyped group, the receiver is stopped and the rebind starts it again.
+    // The audio thread keeps reading the stream buffers meanwhile, so they are
+    // only ever prepared in prepareToPlay
+    if (prepared)
+        streamReceiver.rebind (StreamReceiver::defaultPort, newMembership);
+}
+
+MulticastSocket::Membership ShanPlugin1101AudioProcessor::getMulticastMembership() const
+{
+    const juce::ScopedLock sl (membershipLock);
+    return membership;
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool ShanPlugin1101AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
+    // every stream bus is mono or stereo, auxiliary ones may also be disabled
+    for (int i = 0; i < layouts.outputBuses.size(); ++i)
+    {
+        const auto& set = layouts.outputBuses.getReference (i);
+        if (set != juce::AudioChannelSet::mono()
+         && set != juce::AudioChannelSet::stereo()
+         && ! (i > 0 && set.isDisabled()))
+            return false;
+    }
 
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
+    // the main input has to match the main output so it can sit on an insert
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
-   #endif
 
     return true;
-  #endif
 }
 #endif
 
 void ShanPlugin1101AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
-    // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
 
-        // ..do something to the data...
+    // the input is replaced by the returned streams, stream n goes to output bus n
+    for (int bus = 0; bus < getBusCount (false); ++bus)
+    {
+        auto busBuffer = getBusBuffer (buffer, false, bus);
+        if (busBuffer.getNumChannels() == 0)
+            continue;
+
+        auto& player = streamPlayers[bus];
+        player.render (streamReceiver.getStream (bus),
+                       busBuffer.getArrayOfWritePointers(),
+                       busBuffer.getNumChannels(),
+                       busBuffer.getNumSamples());
+
+        // neither the filter design nor setLatencySamples belong on the audio thread
+        if (player.checkAndClearUpdateRequest())
+            triggerAsyncUpdate();
     }
 }
 
@@ -176,15 +221,27 @@ juce::AudioProcessorEditor* ShanPlugin1101AudioProcessor::createEditor()
 //==============================================================================
 void ShanPlugin1101AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    const auto current = getMulticastMembership();
+
+    juce::XmlElement xml ("ShanPlugin1101");
+    xml.setAttribute ("group", current.group);
+    xml.setAttribute ("source", current.source);
+    xml.setAttribute ("interface", current.interfaceName);
+    xml.setAttribute ("latencyFeed", getLatencyFeedId());
+    copyXmlToBinary (xml, destData);
 }
 
 void ShanPlugin1101AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    if (auto xml = getXmlFromBinary (data, sizeInBytes))
+    {
+        MulticastSocket::Membership restored;
+        restored.group = xml->getStringAttribute ("group");
+        restored.source = xml->getStringAttribute ("source");
+        restored.interfaceName = xml->getStringAttribute ("interface");
+        setMulticastMembership (restored);
+        setLatencyFeedId (xml->getIntAttribute ("latencyFeed", 1));
+    }
 }
 
 //==============================================================================
@@ -9,11 +9,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "StreamReceiver.h"
+#include "StreamPlayer.h"
+#include "LatencyFeed.h"
+#include "ControlConnection.h"
 
 //==============================================================================
 /**
 */
-class ShanPlugin1101AudioProcessor  : public juce::AudioProcessor
+class ShanPlugin1101AudioProcessor  : public juce::AudioProcessor,
+                                      private juce::AsyncUpdater
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
@@ -56,12 +61,42 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
-    bool flag_connection;
-    char msg[5] = "test";
-    int msg_num;
+    // link to the local console, opened by a background thread from the first prepareToPlay
+    const ControlConnection& getControlConnection() const { return controlConnection; }
+    
+    const StreamReceiver& getStreamReceiver() const { return streamReceiver; }
+    
+    // empty group: unicast. Saved with the session and applied right away
+    void setMulticastMembership (const MulticastSocket::Membership& membership);
+    MulticastSocket::Membership getMulticastMembership() const;
+    
+    // id the Compensator follows this instance's latency reports under, saved with the session
+    void setLatencyFeedId (int feedId)  { latencyFeed.setFeedId (feedId); }
+    int getLatencyFeedId() const        { return latencyFeed.getFeedId(); }
 
 private:
-    juce::StreamingSocket socket;
+    static BusesProperties createBusesProperties();
+    
+    // prepares the streams for a changed declared rate and reports the latency that results
+    void handleAsyncUpdate() override;
+    
+    ControlConnection controlConnection;
+    
+    // one socket and thread for all returned feeds, each stream plays on its own output bus
+    StreamReceiver streamReceiver;
+    
+    // converts each stream from its declared wire rate to the host rate and
+    // absorbs the clock drift in the same resampling stage
+    std::array<StreamPlayer, StreamReceiver::maxStreams> streamPlayers;
+    
+    // tells the Compensator how long the main stream currently waits here
+    LatencyFeed latencyFeed;
+    
+    juce::CriticalSection membershipLock;
+    MulticastSocket::Membership membership;
+    
+    // set between prepareToPlay and releaseResources, whether or not the socket could be opened
+    std::atomic<bool> prepared { false };
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ShanPlugin1101AudioProcessor)
 };
@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    PolyphaseResampler.h
+    Windowed-sinc polyphase resampler with a continuously variable ratio.
+
+    The filter table is designed in prepare() for the nominal ratio. The ratio
+    itself can then be nudged every block (clock drift correction) without
+    touching the table, so rate conversion and drift correction share a
+    single resampling stage. A new nominal ratio needs a new cutoff, its table
+    is designed on another thread by stage() and swapped in by the audio
+    thread in adoptStaged(). Coefficients of the two nearest phases are
+    interpolated linearly, the inner loops have a fixed length so the compiler
+    turns them into SIMD code.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class PolyphaseResampler
+{
+public:
+    static constexpr int numTaps = 16;
+    static constexpr int numPhases = 256;
+    static constexpr int maxChannels = 2;
+
+    // drift correction is limited to this fraction of the nominal ratio
+    static constexpr double maxDrift = 0.01;
+
+    // input buffers are sized for anything up to 192 kHz into a 48 kHz host
+    static constexpr double maxRatio = 4.0;
+
+    PolyphaseResampler() = default;
+
+    // allocates, call from prepareToPlay only
+    void prepare (double inputRate, double outputRate, int maxOutputFrames)
+    {
+        currentInputRate = inputRate;
+        nominalStep = juce::jmin (maxRatio, inputRate / outputRate);
+        step = nominalStep;
+
+        table.realloc (tableSize);
+        spareTable.realloc (tableSize);
+        staged = false;
+        design (table, inputRate, outputRate);
+
+        maxBlock = maxOutputFrames;
+        const int maxInput = (int) std::ceil (maxOutputFrames * maxRatio * (1.0 + maxDrift)) + numTaps + 2;
+        input.setSize (maxChannels, maxInput);
+        reset();
+    }
+
+    void reset()
+    {
+        input.clear();
+        numBuffered = numTaps;
+        position = 0.0;
+    }
+
+    // any thread but the audio thread: designs the filter for new rates into
+    // the spare table. False while the previous one is still waiting to be adopted
+    bool stage (double inputRate, double outputRate)
+    {
+        if (staged.load (std::memory_order_acquire))
+            return false;
+
+        stagedInputRate = inputRate;
+        stagedStep = juce::jmin (maxRatio, inputRate / outputRate);
+        design (spareTable, inputRate, outputRate);
+        staged.store (true, std::memory_order_release);
+        return true;
+    }
+
+    // audio thread: switches to the staged filter and ratio, true when there was one
+    bool adoptStaged()
+    {
+        if (! staged.load (std::memory_order_acquire))
+            return false;
+
+        table.swapWith (spareTable);
+        currentInputRate = stagedInputRate;
+        nominalStep = stagedStep;
+        step = nominalStep;
+        staged.store (false, std::memory_order_release);
+        return true;
+    }
+
+    // audio thread: the input rate the current filter was designed for
+    double getInputRate() const         { return currentInputRate; }
+
+    // 1.0 plays at the nominal ratio, > 1.0 consumes input slightly faster
+    void setDriftCorrection (double factor)
+    {
+        step = nominalStep * juce::jlimit (1.0 - maxDrift, 1.0 + maxDrift, factor);
+    }
+
+    int getMaxBlockSize() const         { return maxBlock; }
+    double getNominalRatio() const      { return nominalStep; }
+
+    // group delay of the filter, in output samples
+    double getLatencyInOutputSamples() const
+    {
+        return (numTaps / 2) / nominalStep;
+    }
+
+    // fresh input frames needed before process() can render numFrames outputs
+    int getInputFramesNeeded (int numFrames) const
+    {
+        const int lastIndex = (int) (position + (numFrames - 1) * step);
+        return juce::jmax (0, lastIndex + numTaps - numBuffered);
+    }
+
+    // where the caller writes those fresh frames
+    float* getInputWritePointer (int channel) { return input.getWritePointer (channel, numBuffered); }
+
+    void process (int numFreshFrames, float* const* output, int numOutputChannels, int numFrames)
+    {
+        jassert (numFrames <= maxBlock);
+        numBuffered += numFreshFrames;
+
+        alignas (16) float coeffs[numTaps];
+
+        for (int n = 0; n < numFrames; ++n)
+        {
+            const double pos = position + n * step;
+            const int index = (int) pos;
+            const double phase = (pos - index) * numPhases;
+            const int p = (int) phase;
+            const float frac = (float) (phase - p);
+
+            const float* c0 = table.getData() + p * numTaps;
+            const float* c1 = c0 + numTaps;
+            for (int t = 0; t < numTaps; ++t)
+                coeffs[t] = c0[t] + frac * (c1[t] - c0[t]);
+
+            for (int ch = 0; ch < numOutputChannels; ++ch)
+            {
+                const float* x = input.getReadPointer (juce::jmin (ch, maxChannels - 1), index);
+                float sum = 0.0f;
+                for (int t = 0; t < numTaps; ++t)
+                    sum += coeffs[t] * x[t];
+                output[ch][n] = sum;
+            }
+        }
+
+        // drop what the next block no longer needs, keep the rest as history
+        const double end = position + numFrames * step;
+        const int consumed = juce::jmin ((int) end, numBuffered);
+        position = end - consumed;
+
+        const int remaining = numBuffered - consumed;
+        for (int ch = 0; ch < maxChannels; ++ch)
+        {
+            float* data = input.getWritePointer (ch);
+            std::memmove (data, data + consumed, (size_t) remaining * sizeof (float));
+        }
+        numBuffered = remaining;
+    }
+
+private:
+    // one extra phase so phase p + 1 is always valid while interpolating
+    static constexpr size_t tableSize = (size_t) ((numPhases + 1) * numTaps);
+
+    static void design (juce::HeapBlock<float>& table, double inputRate, double outputRate)
+    {
+        // keep the passband below the lower of the two Nyquist frequencies
+        const double cutoff = 0.95 * juce::jmin (1.0, outputRate / inputRate);
+
+        const double half = numTaps / 2;
+        for (int p = 0; p <= numPhases; ++p)
+        {
+            const double frac = (double) p / numPhases;
+            for (int t = 0; t < numTaps; ++t)
+            {
+                // distance between this tap and the output instant, in input samples
+                const double x = half - 1.0 + frac - t;
+                const double arg = juce::MathConstants<double>::pi * cutoff * x;
+                const double sinc = std::abs (x) < 1.0e-9 ? 1.0 : std::sin (arg) / arg;
+                const double w = juce::jlimit (-1.0, 1.0, x / half);
+                const double blackman = 0.42 + 0.5 * std::cos (juce::MathConstants<double>::pi * w)
+                                             + 0.08 * std::cos (2.0 * juce::MathConstants<double>::pi * w);
+                table[p * numTaps + t] = (float) (cutoff * sinc * blackman);
+            }
+        }
+    }
+
+    juce::HeapBlock<float> table, spareTable;
+    juce::AudioBuffer<float> input;
+    int numBuffered = numTaps;
+    int maxBlock = 0;
+    double position = 0.0;
+    double nominalStep = 1.0;
+    double step = 1.0;
+    double currentInputRate = 48000.0;
+
+    // written by stage() before it sets staged, read by adoptStaged() after
+    double stagedInputRate = 48000.0;
+    double stagedStep = 1.0;
+    std::atomic<bool> staged { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PolyphaseResampler)
+};
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    StreamPacket.h
+    Wire format of the audio streams returned by the remote mixer.
+
+    Every datagram starts with a small header telling which stream it belongs
+    to, followed by interleaved float32 samples. Plain float datagrams without
+    a header (what the Sender plugin writes) are accepted as mono stream 0.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace StreamPacket
+{
+    static constexpr juce::uint32 magic = 0x4f494256; // "VBIO" in little endian
+    static constexpr juce::uint8 version = 1;
+    static constexpr int maxChannels = 2;
+
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint8  version;
+        juce::uint8  numChannels;
+        juce::uint16 streamId;
+        juce::uint32 sequence;
+        juce::uint32 sampleRate;    // 0 when the sender did not declare it
+        juce::uint16 numFrames;
+        juce::uint16 reserved;
+    };
+
+    static_assert (sizeof (Header) == 20, "the header is sent as raw bytes");
+
+    struct View
+    {
+        int streamId = 0;
+        int numChannels = 1;
+        int numFrames = 0;
+        int sampleRate = 0;
+        juce::uint32 sequence = 0;
+        bool hasSequence = false;
+        const float* samples = nullptr;   // interleaved
+    };
+
+    // returns false when the datagram is malformed
+    inline bool parse (const void* data, int numBytes, View& view)
+    {
+        if (numBytes >= (int) sizeof (Header))
+        {
+            Header header;
+            std::memcpy (&header, data, sizeof (Header));
+
+            if (header.magic == magic)
+            {
+                if (header.version != version
+                    || header.numChannels < 1 || header.numChannels > maxChannels)
+                    return false;
+
+                const int payload = numBytes - (int) sizeof (Header);
+                if (payload < (int) (header.numFrames * header.numChannels * sizeof (float)))
+                    return false;
+
+                view.streamId    = header.streamId;
+                view.numChannels = header.numChannels;
+                view.numFrames   = header.numFrames;
+                view.sampleRate  = (int) header.sampleRate;
+                view.sequence    = header.sequence;
+                view.hasSequence = true;
+                view.samples     = reinterpret_cast<const float*> (static_cast<const char*> (data) + sizeof (Header));
+                return true;
+            }
+        }
+
+        // legacy headerless datagram: raw mono floats
+        view.streamId    = 0;
+        view.numChannels = 1;
+        view.numFrames   = numBytes / (int) sizeof (float);
+        view.sampleRate  = 0;
+        view.hasSequence = false;
+        view.samples     = static_cast<const float*> (data);
+        return view.numFrames > 0;
+    }
+}
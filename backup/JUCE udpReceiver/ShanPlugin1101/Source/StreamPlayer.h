@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    StreamPlayer.h
+    Plays one received stream at the host rate.
+
+    Pulls wire-rate audio from the stream's JitterBuffer through a single
+    PolyphaseResampler. A small PI controller watches the jitter buffer fill
+    and trims the resampling ratio, so the sender/host clock drift is absorbed
+    by the same stage that converts the declared wire rate to the host rate.
+
+    When a stream declares another rate, the resampler's filter for it is
+    designed on the message thread in update(). The stream is muted on the
+    audio thread until the new filter is in place.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "JitterBuffer.h"
+#include "PolyphaseResampler.h"
+
+class StreamPlayer
+{
+public:
+    // rate assumed until the stream declares its own, what the phone/WebRTC side sends
+    static constexpr int defaultWireRate = 48000;
+
+    StreamPlayer() = default;
+
+    void prepare (double hostSampleRate, int wireSampleRate, int maxBlockSize, int targetFrames)
+    {
+        hostRate = hostSampleRate;
+        wireRate = wireSampleRate > 0 ? wireSampleRate : defaultWireRate;
+        target = targetFrames;
+
+        resampler.prepare (wireRate, hostRate, maxBlockSize);
+        stagedWireRate = wireRate;
+        averageFill = target;
+        integral = 0.0;
+        playoutDelay = 0.0;
+        latencySamples = computeLatencySamples();
+        updateRequested = false;
+    }
+
+    // renders numFrames host-rate frames, in chunks the resampler was prepared for
+    void render (JitterBuffer& stream, float* const* output, int numChannels, int numFrames)
+    {
+        // follow a declared rate that differs from the one we prepared for,
+        // the message thread designs the filter for it
+        const int declared = stream.getSampleRate();
+        if (declared > 0 && declared != wireRate)
+        {
+            wireRate = declared;
+            updateRequested = true;
+        }
+
+        // the processor reports the new latency from the message thread
+        if (resampler.adoptStaged())
+        {
+            latencySamples = computeLatencySamples();
+            updateRequested = true;
+        }
+
+        // a filter for a rate the stream already left is replaced once more
+        const bool filterMatches = (int) resampler.getInputRate() == wireRate;
+        if (! filterMatches)
+            updateRequested = true;
+
+        updateDriftCorrection (stream.getNumReady());
+        playoutDelay = averageFill / wireRate + resampler.getLatencyInOutputSamples() / hostRate;
+
+        for (int offset = 0; offset < numFrames;)
+        {
+            const int chunk = juce::jmin (numFrames - offset, resampler.getMaxBlockSize());
+            const int needed = resampler.getInputFramesNeeded (chunk);
+
+            float* fresh[PolyphaseResampler::maxChannels];
+            for (int ch = 0; ch < PolyphaseResampler::maxChannels; ++ch)
+                fresh[ch] = resampler.getInputWritePointer (ch);
+            stream.pop (fresh, PolyphaseResampler::maxChannels, needed);
+
+            float* out[PolyphaseResampler::maxChannels];
+            for (int ch = 0; ch < numChannels; ++ch)
+                out[ch] = output[ch] + offset;
+            resampler.process (needed, out, numChannels, chunk);
+
+            offset += chunk;
+        }
+
+        // played at the wrong ratio, or aliased through the old filter otherwise
+        if (! filterMatches)
+            for (int ch = 0; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::clear (output[ch], numFrames);
+    }
+
+    // jitter buffer target plus the filter's group delay, in host samples, any thread
+    int getLatencySamples() const { return latencySamples; }
+
+    // audio thread: true once when update() has work for the message thread
+    bool checkAndClearUpdateRequest() { return updateRequested.exchange (false); }
+
+    // message thread: designs the filter for the rate the stream declared last
+    void update()
+    {
+        const int rate = wireRate;
+        if (rate != stagedWireRate && resampler.stage (rate, hostRate))
+            stagedWireRate = rate;
+    }
+
+    // what is queued plus the filter's group delay, in seconds. Follows the
+    // smoothed fill rather than the target, so it grows while the network
+    // bunches datagrams up and shrinks as the drift correction drains them
+    double getPlayoutDelaySeconds() const { return playoutDelay; }
+
+private:
+    int computeLatencySamples() const
+    {
+        return juce::roundToInt (target * hostRate / resampler.getInputRate() + resampler.getLatencyInOutputSamples());
+    }
+
+    void updateDriftCorrection (int fill)
+    {
+        // fill is noisy (it moves by a datagram at a time), smooth it over ~100 blocks
+        averageFill += 0.01 * (fill - averageFill);
+
+        const double error = (averageFill - target) / juce::jmax (1, target);
+        integral = juce::jlimit (-PolyphaseResampler::maxDrift, PolyphaseResampler::maxDrift,
+                                 integral + 1.0e-5 * error);
+
+        // too much queued: play slightly faster, too little: slightly slower
+        resampler.setDriftCorrection (1.0 + 1.0e-3 * error + integral);
+    }
+
+    PolyphaseResampler resampler;
+    double hostRate = 48000.0;
+    std::atomic<int> wireRate { defaultWireRate };
+    int target = 0;
+
+    // message thread only
+    int stagedWireRate = defaultWireRate;
+
+    double averageFill = 0.0;
+    double integral = 0.0;
+    std::atomic<bool> updateRequested { false };
+    std::atomic<double> playoutDelay { 0.0 };
+    std::atomic<int> latencySamples { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamPlayer)
+};
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    StreamReceiver.cpp
+
+  ==============================================================================
+*/
+
+#include "StreamReceiver.h"
+
+namespace
+{
+    constexpr int maxDatagramBytes = 65536;
+}
+
+StreamReceiver::StreamReceiver()
+    : juce::Thread ("StreamReceiver"),
+      datagram (maxDatagramBytes / sizeof (float)),
+      status ("opens when playback starts")
+{
+}
+
+StreamReceiver::~StreamReceiver()
+{
+    stop();
+}
+
+bool StreamReceiver::start (int port, int targetFrames, const MulticastSocket::Membership& membership)
+{
+    stop();
+
+    for (auto& stream : streams)
+        stream.prepare (targetFrames);
+
+    if (! open (port, membership))
+        return false;
+
+    startThread (juce::Thread::Priority::high);
+    return true;
+}
+
+bool StreamReceiver::rebind (int port, const MulticastSocket::Membership& membership)
+{
+    stop();
+
+    if (! open (port, membership))
+        return false;
+
+    startThread (juce::Thread::Priority::high);
+    return true;
+}
+
+void StreamReceiver::stop()
+{
+    stopThread (500);
+}
+
+bool StreamReceiver::open (int port, const MulticastSocket::Membership& membership)
+{
+    juce::String error;
+    const bool opened = socket.open (port, membership, error);
+
+    const juce::ScopedLock sl (statusLock);
+    if (! opened)
+        status = error;
+    else if (membership.group.isEmpty())
+        status = "unicast :" + juce::String (port);
+    else
+        status = membership.group + " :" + juce::String (port)
+                   + (socket.isSourceSpecific() ? " (SSM from " + membership.source + ")" : juce::String());
+
+    return opened;
+}
+
+juce::String StreamReceiver::getStatus() const
+{
+    const juce::ScopedLock sl (statusLock);
+    return status;
+}
+
+void StreamReceiver::run()
+{
+    while (! threadShouldExit())
+    {
+        // time out regularly so stopThread() is honoured on a silent socket
+        if (socket.waitUntilReadable (50) != 1)
+            continue;
+
+        const int bytes = socket.read (datagram.getData(), maxDatagramBytes);
+        if (bytes <= 0)
+            continue;
+
+        StreamPacket::View packet;
+        if (! StreamPacket::parse (datagram.getData(), bytes, packet))
+            continue;
+
+        if (packet.streamId >= maxStreams)
+        {
+            ++unknownStreamPackets;
+            continue;
+        }
+
+        streams[(size_t) packet.streamId].push (packet);
+    }
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    StreamReceiver.h
+    One UDP socket and one network thread serving every returned stream.
+
+    Datagrams are demultiplexed by their stream id into a JitterBuffer per
+    stream, the audio thread then pulls each stream into its own output bus.
+    The socket either receives unicast or joins a multicast group, so one sent
+    mixer return can feed any number of receivers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "JitterBuffer.h"
+#include "MulticastSocket.h"
+
+class StreamReceiver  : private juce::Thread
+{
+public:
+    static constexpr int maxStreams = 8;
+    static constexpr int defaultPort = 41235;
+
+    StreamReceiver();
+    ~StreamReceiver() override;
+
+    // (re)binds the socket and restarts the network thread with fresh buffers
+    bool start (int port, int targetFrames, const MulticastSocket::Membership& membership = {});
+    void stop();
+
+    // switches port or group while playing, the stream buffers are left alone.
+    // Also starts the network thread again after a failed start or rebind
+    bool rebind (int port, const MulticastSocket::Membership& membership);
+
+    bool isBound() const { return socket.isOpen(); }
+    bool isRunning() const { return isThreadRunning(); }
+
+    // "unicast :41235", "239.1.2.3 :41235 (SSM)" or why the socket could not be opened
+    juce::String getStatus() const;
+
+    JitterBuffer& getStream (int index) { return streams[(size_t) index]; }
+    const JitterBuffer& getStream (int index) const { return streams[(size_t) index]; }
+
+    int getUnknownStreamPackets() const { return unknownStreamPackets; }
+
+private:
+    void run() override;
+    bool open (int port, const MulticastSocket::Membership& membership);
+
+    MulticastSocket socket;
+    std::array<JitterBuffer, maxStreams> streams;
+    juce::HeapBlock<float> datagram;    // float aligned so payloads can be read in place
+    std::atomic<int> unknownStreamPackets { 0 };
+
+    juce::CriticalSection statusLock;
+    juce::String status;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamReceiver)
+};
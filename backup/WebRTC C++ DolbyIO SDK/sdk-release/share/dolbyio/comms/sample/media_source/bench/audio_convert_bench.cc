@@ -0,0 +1,197 @@
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+// Throughput of the decoded audio path from an AVFrame to the injector's
+// audio_buffer. It needs the libavutil headers only, no SDK and no libav
+// libraries, so it builds straight from media_source:
+//   g++ -std=c++17 -O2 -I../../.. -I../ffmpeg-headers bench/audio_convert_bench.cc file/utils/audio_buffer.cc
+//       file/utils/sample_convert.cc file/utils/audio_converter.cc
+// or with -DMEDIA_SOURCE_BENCH=ON in the sample build.
+//
+// Decoded frames of 1024 samples are written into 10 ms buffers at 48 kHz,
+// in chunks up to the end of each buffer the way process_audio does it, and
+// timed in millions of samples per second.
+//   interleave   float planar to int16, the per sample push loop that
+//                process_audio had against the bulk kernel
+//   formats      audio_converter for every sample format the decoders
+//                produce, mono, stereo and 5.1 downmixed to stereo
+
+#include "comms/sample/media_source/file/utils/audio_buffer.h"
+#include "comms/sample/media_source/file/utils/audio_converter.h"
+#include "comms/sample/media_source/file/utils/sample_convert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace dolbyio::comms::sample;
+
+constexpr int sample_rate = 48000;
+constexpr int frame_samples = 1024;
+constexpr int buffer_samples = sample_rate / 100;
+constexpr int frames_per_run = 2000;
+constexpr int runs = 3;
+
+// planar decoder output, one frame
+struct planar_frame {
+  planar_frame(int channels) : samples(static_cast<size_t>(channels) * frame_samples), planes(channels) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& s : samples)
+      s = dist(random);
+    for (int ch = 0; ch < channels; ++ch)
+      planes[ch] = samples.data() + static_cast<size_t>(ch) * frame_samples;
+  }
+
+  std::vector<float> samples;
+  std::vector<const float*> planes;
+};
+
+// process_audio before the bulk writes
+void push_loop(const planar_frame& frame, int channels, audio_buffer& buf) {
+  for (int i = 0; i < frame_samples; ++i) {
+    if (buf.full())
+      buf.reset();
+    for (int ch = 0; ch < channels; ++ch) {
+      double val = frame.planes[ch][i] * std::numeric_limits<int16_t>::max();
+      buf.push(val);
+    }
+  }
+}
+
+void bulk_write(const planar_frame& frame, int channels, audio_buffer& buf) {
+  for (int offset = 0; offset < frame_samples;) {
+    if (buf.full())
+      buf.reset();
+    const int chunk = std::min(frame_samples - offset, buf.frames_free());
+    planar_float_to_interleaved_s16(frame.planes.data(), channels, offset, chunk, buf.write_position());
+    buf.commit(chunk);
+    offset += chunk;
+  }
+}
+
+// best of runs, in millions of samples per second over all channels
+template <typename Convert>
+double measure(int channels, Convert&& convert) {
+  double best = 0.0;
+  for (int run = 0; run < runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames_per_run; ++i)
+      convert();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::max(best, static_cast<double>(frames_per_run) * frame_samples * channels / elapsed.count() / 1e6);
+  }
+  return best;
+}
+
+void interleave() {
+  std::printf("interleave, Msamples/s\n%9s  %10s  %10s  %7s\n", "channels", "push loop", "bulk", "speedup");
+  for (int channels : {1, 2}) {
+    const planar_frame frame(channels);
+    audio_buffer buf(buffer_samples, sample_rate, channels);
+    const double before = measure(channels, [&]() { push_loop(frame, channels, buf); });
+    const double after = measure(channels, [&]() { bulk_write(frame, channels, buf); });
+    std::printf("%9d  %10.1f  %10.1f  %6.2fx\n", channels, before, after, after / before);
+  }
+}
+
+// one frame of decoder output in any sample format, as AVFrame::extended_data points to it
+struct decoded_frame {
+  decoded_frame(AVSampleFormat format, int channels) {
+    const bool planar = format == AV_SAMPLE_FMT_S16P || format == AV_SAMPLE_FMT_S32P ||
+                        format == AV_SAMPLE_FMT_FLTP || format == AV_SAMPLE_FMT_DBLP;
+    const int plane_count = planar ? channels : 1;
+    const int plane_samples = planar ? frame_samples : frame_samples * channels;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (int p = 0; p < plane_count; ++p) {
+      switch (format) {
+        case AV_SAMPLE_FMT_S16:
+        case AV_SAMPLE_FMT_S16P:
+          planes.push_back(fill<int16_t>(plane_samples, 32767.0, random, dist));
+          break;
+        case AV_SAMPLE_FMT_S32:
+        case AV_SAMPLE_FMT_S32P:
+          planes.push_back(fill<int32_t>(plane_samples, 2147483647.0, random, dist));
+          break;
+        case AV_SAMPLE_FMT_FLT:
+        case AV_SAMPLE_FMT_FLTP:
+          planes.push_back(fill<float>(plane_samples, 1.0, random, dist));
+          break;
+        default:
+          planes.push_back(fill<double>(plane_samples, 1.0, random, dist));
+          break;
+      }
+    }
+    for (const auto& plane : planes)
+      data.push_back(plane.data());
+  }
+
+  template <typename T>
+  static std::vector<uint8_t> fill(int count,
+                                   double scale,
+                                   std::mt19937& random,
+                                   std::uniform_real_distribution<double>& dist) {
+    std::vector<uint8_t> bytes(static_cast<size_t>(count) * sizeof(T));
+    T* samples = reinterpret_cast<T*>(bytes.data());
+    for (int i = 0; i < count; ++i)
+      samples[i] = static_cast<T>(dist(random) * scale);
+    return bytes;
+  }
+
+  std::vector<std::vector<uint8_t>> planes;
+  std::vector<const uint8_t*> data;
+};
+
+// process_audio's loop
+void convert_frame(audio_converter& converter, const decoded_frame& frame, audio_buffer& buf) {
+  for (int offset = 0; offset < frame_samples;) {
+    if (buf.full())
+      buf.reset();
+    const int chunk = std::min(frame_samples - offset, buf.frames_free());
+    converter.convert(frame.data.data(), offset, chunk, buf.write_position());
+    buf.commit(chunk);
+    offset += chunk;
+  }
+}
+
+void formats() {
+  const std::pair<AVSampleFormat, const char*> sample_formats[] = {
+      {AV_SAMPLE_FMT_S16, "s16"}, {AV_SAMPLE_FMT_S16P, "s16p"}, {AV_SAMPLE_FMT_S32, "s32"},
+      {AV_SAMPLE_FMT_S32P, "s32p"}, {AV_SAMPLE_FMT_FLT, "flt"}, {AV_SAMPLE_FMT_FLTP, "fltp"},
+      {AV_SAMPLE_FMT_DBL, "dbl"}, {AV_SAMPLE_FMT_DBLP, "dblp"}};
+
+  std::printf("\nformats, input Msamples/s\n%7s  %8s  %8s  %8s\n", "format", "mono", "stereo", "5.1 to 2");
+  for (const auto& [format, name] : sample_formats) {
+    std::printf("%7s", name);
+    for (int channels : {1, 2, 6}) {
+      const int out_channels = audio_converter::output_channels(channels);
+      const decoded_frame frame(format, channels);
+      audio_converter converter;
+      converter.configure(format, channels, 0, out_channels);
+      audio_buffer buf(buffer_samples, sample_rate, out_channels);
+      std::printf("  %8.1f", measure(channels, [&]() { convert_frame(converter, frame, buf); }));
+    }
+    std::printf("\n");
+  }
+}
+
+}  // namespace
+
+int main() {
+  interleave();
+  formats();
+  return 0;
+}
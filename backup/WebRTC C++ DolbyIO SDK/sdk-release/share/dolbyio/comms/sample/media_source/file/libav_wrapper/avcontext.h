@@ -26,6 +26,11 @@ struct audio {
   bool dummy = false;
 };
 
+struct packet_deleter {
+  void operator()(AVPacket* packet) const { av_packet_free(&packet); }
+};
+using packet_ptr = std::unique_ptr<AVPacket, packet_deleter>;
+
 struct media {
   void reset() {
     decoder_.reset();
@@ -47,11 +52,15 @@ class libav_context {
   libav_context(const std::string& name) noexcept(false);
   ~libav_context();
 
-  bool create_decoder(AVMediaType type);
+  bool create_decoder(AVMediaType type, decoder_threading threading = {});
 
   int read_single_packet();
   void packet_finished();
-  int packet_to_decoder(bool capture_video, bool capture_audio);
+  // moves the packet read last out, so another thread can decode it
+  packet_ptr take_packet();
+
+  template <typename T>
+  int packet_to_decoder(AVPacket* packet);
 
   template <typename T>
   int frame_from_decoder(frame* frame);
@@ -59,6 +68,7 @@ class libav_context {
   bool is_audio() const { return packet_->stream_index == audio_.index; }
   bool is_video() const { return packet_->stream_index == video_.index; }
 
+  // only while no decoder thread runs, the decoders start over at the new position
   bool seek_set_time();
   bool set_next_seek_time(int64_t time);
   std::chrono::milliseconds frame_interval();
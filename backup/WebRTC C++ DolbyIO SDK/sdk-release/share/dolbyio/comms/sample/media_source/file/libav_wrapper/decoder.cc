@@ -9,13 +9,43 @@
 
 #include "comms/sample/media_source/file/libav_wrapper/decoder.h"
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace dolbyio::comms::sample {
 
-decoder::decoder(AVStream* stream, bool refcount) noexcept(false)
+namespace {
+
+// Frame threading decodes several frames at once for a frame of latency per
+// extra thread, which a file source can afford. Slice threading adds none
+// but only helps streams encoded with several slices, so both are enabled and
+// libavcodec uses frame threading where the codec has it.
+void choose_threading(const AVCodec* codec, decoder_threading& threading) {
+  if (codec->type != AVMEDIA_TYPE_VIDEO) {
+    if (!threading.count)
+      threading.count = 1;
+    return;
+  }
+  if (!threading.count) {
+    // leave a core to demuxing, audio and the injector, more than eight
+    // threads only adds memory and latency below 4K
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    threading.count = std::clamp(cores - 1, 1, 8);
+  }
+  if (!threading.type) {
+    if (codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+      threading.type |= FF_THREAD_FRAME;
+    if (codec->capabilities & AV_CODEC_CAP_SLICE_THREADS)
+      threading.type |= FF_THREAD_SLICE;
+  }
+}
+
+}  // namespace
+
+decoder::decoder(AVStream* stream, bool refcount, decoder_threading threading) noexcept(false)
     : stream_(stream) {
   int av_return = 0;
 
@@ -38,9 +68,22 @@ decoder::decoder(AVStream* stream, bool refcount) noexcept(false)
     std::cerr << "Failed to add " << (refcount ? "refcounted" : "non-refcounted")
               << " option to dictionary:" + std::to_string(av_return) << ". Not fatal, continuing!\n";
   }
+  choose_threading(codec_, threading);
+  context_->thread_count = threading.count;
+  if (threading.type)
+    context_->thread_type = threading.type;
   if ((av_return = avcodec_open2(context_, codec_, &options)) < 0) {
     throw std::runtime_error("Failed to open codec! code:" + std::to_string(av_return));
   }
+  if (context_->codec_type == AVMEDIA_TYPE_VIDEO)
+    std::cerr << "Video decoder " << codec_->name << ": " << context_->thread_count << " threads"
+              << (context_->active_thread_type & FF_THREAD_FRAME ? ", frame" : "")
+              << (context_->active_thread_type & FF_THREAD_SLICE ? ", slice" : "") << " threading, "
+              << frame_delay() << " frames of delay\n";
+}
+
+int decoder::frame_delay() const {
+  return context_->active_thread_type & FF_THREAD_FRAME ? context_->thread_count - 1 : 0;
 }
 
 decoder::~decoder() {
@@ -60,4 +103,8 @@ int decoder::receive(dolbyio::comms::sample::frame* frame) {
   return ret;
 }
 
+void decoder::flush() {
+  avcodec_flush_buffers(context_);
+}
+
 };  // namespace dolbyio::comms::sample
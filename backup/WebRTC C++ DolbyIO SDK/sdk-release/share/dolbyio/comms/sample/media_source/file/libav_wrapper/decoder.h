@@ -17,17 +17,29 @@ extern "C" {
 
 namespace dolbyio::comms::sample {
 
+// Zero leaves the choice to the decoder: video decodes on up to one thread
+// per spare core with every threading type the codec supports, audio on one.
+struct decoder_threading {
+  int count = 0;  // decoding threads, 1 turns threading off
+  int type = 0;   // FF_THREAD_FRAME, FF_THREAD_SLICE or both
+};
+
 class decoder {
  public:
-  explicit decoder(AVStream* stream, bool refcount) noexcept(false);
+  explicit decoder(AVStream* stream, bool refcount, decoder_threading threading = {}) noexcept(false);
   ~decoder();
 
   int send(AVPacket* packet);
   int receive(frame* frame);
+  // drops the frames held for packets sent so far and leaves draining mode
+  void flush();
 
   AVCodecContext* codec_context() { return context_; }
   int channels() { return context_->channels; }
   int sample_rate() { return context_->sample_rate; }
+  // frames a packet takes to come out again, one per extra frame thread. The
+  // paced injector does not see it, its 10 frame queue is kept filled ahead.
+  int frame_delay() const;
 
  private:
   AVStream* stream_;
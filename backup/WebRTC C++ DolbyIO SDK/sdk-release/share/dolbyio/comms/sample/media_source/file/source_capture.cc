@@ -9,9 +9,19 @@
 
 #include "comms/sample/media_source/file/source_capture.h"
 
+namespace dolbyio::comms::sample {
 
+namespace {
 
-namespace dolbyio::comms::sample {
+void set_thread_name(const char* name) {
+#if defined(__APPLE__)
+  pthread_setname_np(name);
+#elif defined(__linux__)
+  pthread_setname_np(pthread_self(), name);
+#endif
+}
+
+}  // namespace
 
 std::unique_ptr<file_source> file_source::create(std::vector<std::string>&& files,
                                                  bool loop,
@@ -25,10 +35,13 @@ file_source::file_source(std::vector<std::string>&& files,
                          dolbyio::comms::plugin::injector_paced& injector,
                          std::function<void(const file_source_status&)>&& status_cb)
     : injector_(injector),
+      // the paced injector queues up to 10 video frames and a second of
+      // audio, the capacities leave room for the decoder on top of that
       video_pool_(std::make_unique<frame_pool<frame>>(
           20,
           []() { return (new frame()); },
-          [](frame* f) { delete f; })),
+          [](frame* f) { delete f; },
+          frame_pool_limits{32, frame_pool_policy::block, std::chrono::milliseconds(500)})),
       input_files_(std::move(files)),
       curr_file_(input_files_.begin()),
       capture_thread_([this]() {
@@ -70,6 +83,9 @@ file_source::~file_source() {
   } catch (const std::exception& e) {
     std::cerr << "Error: Joining capture_thread threw: " << e.what() << std::endl;
   }
+  if (audio_pool_)
+    std::cerr << "Audio frame pool: " << audio_pool_->stats() << "\n";
+  std::cerr << "Video frame pool: " << video_pool_->stats() << "\n";
   audio_pool_.reset();
   video_pool_.reset();
   libav_context_.reset();
@@ -298,10 +314,11 @@ bool file_source::initialize_av_context() {
 
   // If the format of the audio in file is different we need a new audio frame
   // pool.
-  if (!file_state_.audio.compare(libav_context_->sample_rate(), libav_context_->channels()))
+  const int channels = audio_converter::output_channels(libav_context_->channels());
+  if (!file_state_.audio.compare(libav_context_->sample_rate(), channels))
     allocate_audio_frame_pool();
 
-  file_state_.audio.settings(libav_context_->sample_rate(), libav_context_->channels());
+  file_state_.audio.settings(libav_context_->sample_rate(), channels);
   injector_.set_video_frame_interval(libav_context_->frame_interval());
   return true;
 }
@@ -315,49 +332,64 @@ int file_source::queue_video_frame(video_pool_frame_ptr&& value) {
 }
 
 void file_source::allocate_audio_frame_pool() {
+  if (audio_pool_)
+    std::cerr << "Audio frame pool: " << audio_pool_->stats() << "\n";
   audio_pool_ = std::make_unique<frame_pool<audio_buffer>>(
       100,
-      [samples{libav_context_->sample_rate() / 100}, channels{libav_context_->channels()},
+      [samples{libav_context_->sample_rate() / 100}, channels{audio_converter::output_channels(libav_context_->channels())},
        sample_rate{libav_context_->sample_rate()}]() -> audio_buffer* {
         return new audio_buffer(samples, sample_rate, channels);
       },
-      std::default_delete<audio_buffer>());
+      std::default_delete<audio_buffer>(),
+      frame_pool_limits{128, frame_pool_policy::block, std::chrono::milliseconds(500)});
+}
+
+audio_pool_frame_ptr file_source::get_audio_buffer() {
+  audio_buffer* buf = audio_pool_->get_frame();
+  if (!buf)
+    return nullptr;
+  return std::make_unique<frame_from_pool<audio_buffer>>(buf, *audio_pool_, [](audio_buffer* buf) { buf->reset(); });
 }
 
-// right now only f32lpp, handle other input formats for audio
 audio_pool_frame_ptr file_source::process_audio(audio_pool_frame_ptr&& curr_buff, frame& aframe) {
+  // the pool ran dry last time, try again before giving up on this frame
+  if (!curr_buff)
+    curr_buff = get_audio_buffer();
   if (!curr_buff) {
-    std::cerr << "Current audio buffer is null!\n";
+    std::cerr << "Audio frame pool exhausted, dropping audio!\n";
     return nullptr;
   }
   if (!aframe) {
     std::cerr << "No AVFrame provided!\n";
     return std::move(curr_buff);
   }
-  if (aframe->format != AV_SAMPLE_FMT_FLTP) {
-    std::cerr << "Currently only support AVFrame format Float Planar!\n";
+  const int out_channels = curr_buff->val()->channels();
+  if (!audio_converter_.matches(aframe->format, aframe->channels, aframe->channel_layout, out_channels) &&
+      !audio_converter_.configure(aframe->format, aframe->channels, aframe->channel_layout, out_channels)) {
+    const char* name = av_get_sample_fmt_name(static_cast<AVSampleFormat>(aframe->format));
+    std::cerr << "Unsupported audio sample format " << (name ? name : "unknown") << "!\n";
     return std::move(curr_buff);
   }
 
-  float* channel_buffer[AV_NUM_DATA_POINTERS] = {0};
-  for (int i = 0; i < aframe->channels; ++i)
-    channel_buffer[i] = reinterpret_cast<float*>(aframe->data[i]);
-
-  for (int i = 0; i < aframe->nb_samples; ++i) {
+  // as many frames at a time as fit before the buffer is full
+  for (int offset = 0; offset < aframe->nb_samples;) {
     if (curr_buff->val()->full()) {
       queue_audio_frame(std::move(curr_buff));
-      curr_buff.reset(new frame_from_pool<audio_buffer>(audio_pool_->get_frame(), *audio_pool_,
-                                                        [](audio_buffer* buf) { buf->reset(); }));
-    }
-    for (int j = 0; j < aframe->channels; ++j) {
-      double val = channel_buffer[j][i] * std::numeric_limits<int16_t>::max();
-      curr_buff->val()->push(val);
+      curr_buff = get_audio_buffer();
+      if (!curr_buff) {
+        std::cerr << "Audio frame pool exhausted, dropping audio!\n";
+        return nullptr;
+      }
     }
+    audio_buffer* buf = curr_buff->val();
+    const int chunk = std::min(aframe->nb_samples - offset, buf->frames_free());
+    audio_converter_.convert(aframe->extended_data, offset, chunk, buf->write_position());
+    buf->commit(chunk);
+    offset += chunk;
   }
   if (curr_buff->val()->full()) {
     queue_audio_frame(std::move(curr_buff));
-    curr_buff.reset(new frame_from_pool<audio_buffer>(audio_pool_->get_frame(), *audio_pool_,
-                                                      [](audio_buffer* buf) { buf->reset(); }));
+    curr_buff = get_audio_buffer();
   }
   return std::move(curr_buff);
 }
@@ -430,6 +462,9 @@ void file_source::capture_loop_exited() {
     injector_.stop_video_injection(true /*force stoppage*/);
 
     if (state == file_state::SEEK) {
+      // decoded before the seek, injecting them would play the old position first
+      injector_.clear_audio_queue();
+      injector_.clear_video_queue();
       libav_context_->seek_set_time();
       restart = restart_capture(false);
     } else if (state == file_state::NEW) {
@@ -446,56 +481,129 @@ void file_source::capture_loop_exited() {
 }
 
 void file_source::capture_loop() {
-  {
-    audio_pool_frame_ptr reference_audio_frame(new frame_from_pool<audio_buffer>(
-        audio_pool_->get_frame(), *audio_pool_, [](audio_buffer* buf) { buf->reset(); }));
-
-    auto audio_read_frame = std::make_unique<frame>();
-    file_state_.playing();
-    int ret = 0;
-    while (libav_context_->read_single_packet() >= 0) {
-      {
-        // Check if the state of the file has changed externally
-        std::lock_guard<std::mutex> lock(capture_lock_);
-        file_state::state_change state = file_state_.state();
-        if (state != file_state::PLAYING) {
-          if (state != file_state::PAUSE)
-            libav_context_->packet_finished();
+  file_state_.playing();
+  audio_packets_.reopen();
+  video_packets_.reopen();
+  std::thread audio_decoder([this]() {
+    set_thread_name("injection_audio");
+    audio_decode_loop();
+  });
+  std::thread video_decoder([this]() {
+    set_thread_name("injection_video");
+    video_decode_loop();
+  });
+
+  const auto stopped = [this]() { return decoding_stopped(); };
+  while (libav_context_->read_single_packet() >= 0) {
+    // Check if the state of the file has changed externally
+    file_state::state_change state = file_state_.state();
+    if (state != file_state::PLAYING) {
+      if (state != file_state::PAUSE)
+        libav_context_->packet_finished();
+      break;
+    }
+
+    spsc_queue<packet_ptr>* queue = nullptr;
+    if (libav_context_->is_video() && capture_state_.capture_video)
+      queue = &video_packets_;
+    else if (libav_context_->is_audio() && capture_state_.capture_audio)
+      queue = &audio_packets_;
+    if (!queue) {
+      libav_context_->packet_finished();
+      continue;
+    }
+
+    // the packet stays read but not taken while paused, like above
+    if (!queue->wait_for_space(stopped)) {
+      if (file_state_.state() != file_state::PAUSE)
+        libav_context_->packet_finished();
+      break;
+    }
+    packet_ptr packet = libav_context_->take_packet();
+    if (packet)
+      queue->try_push(packet);
+  }
+
+  // at the end of the file the decoders finish what is queued, otherwise
+  // they stop at the next packet
+  audio_packets_.close();
+  video_packets_.close();
+  audio_decoder.join();
+  video_decoder.join();
+
+  // a paused file resumes with the packets still queued
+  if (file_state_.state() != file_state::PAUSE) {
+    audio_packets_.clear();
+    video_packets_.clear();
+  }
+  capture_loop_exited();
+}
+
+void file_source::audio_decode_loop() {
+  audio_pool_frame_ptr reference_audio_frame = get_audio_buffer();
+  auto audio_read_frame = std::make_unique<frame>();
+
+  packet_ptr packet;
+  for (bool end_of_file = false; !end_of_file;) {
+    if (!audio_packets_.pop(packet, [this]() { return decoding_stopped(); })) {
+      if (decoding_stopped())
+        break;
+      // the null packet left in packet drains the decoder at the end of the file
+      end_of_file = true;
+    }
+    int ret = libav_context_->packet_to_decoder<audio>(packet.get());
+    packet.reset();
+    while (ret >= 0) {
+      ret = libav_context_->frame_from_decoder<audio>(audio_read_frame.get());
+      if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+        break;
+
+      // this will return the current audio frame that contains the packets
+      // which are left over from last fillage
+      reference_audio_frame = process_audio(std::move(reference_audio_frame), *audio_read_frame);
+      audio_read_frame->unref();
+    }
+  }
+}
+
+void file_source::video_decode_loop() {
+  // decodes a video frame the pool had no room for, so the decoder is still drained
+  auto dropped_video_frame = std::make_unique<frame>();
+
+  packet_ptr packet;
+  for (bool end_of_file = false; !end_of_file;) {
+    if (!video_packets_.pop(packet, [this]() { return decoding_stopped(); })) {
+      if (decoding_stopped())
+        break;
+      // a frame threaded decoder still holds its last frame_delay() frames,
+      // the null packet left in packet makes it return them
+      end_of_file = true;
+    }
+    int ret = libav_context_->packet_to_decoder<video>(packet.get());
+    packet.reset();
+    while (ret >= 0) {
+      auto vframe = video_pool_->get_frame();
+      if (!vframe) {
+        ret = libav_context_->frame_from_decoder<video>(dropped_video_frame.get());
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
           break;
-        }
-        ret = libav_context_->packet_to_decoder(capture_state_.capture_video, capture_state_.capture_audio);
+        dropped_video_frame->unref();
+        std::cerr << "Video frame pool exhausted, dropping a frame!\n";
+        continue;
       }
-      while (ret >= 0) {
-        if (libav_context_->is_video()) {
-          auto vframe = video_pool_->get_frame();
-          ret = libav_context_->frame_from_decoder<video>(vframe);
-          if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            video_pool_->return_frame(vframe);
-            break;
-          }
-          if (vframe->raw()->format != AV_PIX_FMT_YUV420P) {
-            video_pool_->return_frame(vframe);
-            std::cerr << "Bad video frame format" << std::endl;
-            break;
-          }
-          queue_video_frame(
-              std::make_unique<frame_from_pool<frame>>(vframe, *video_pool_, [](frame* f) { f->unref(); }));
-        } else if (libav_context_->is_audio()) {
-          ret = libav_context_->frame_from_decoder<audio>(audio_read_frame.get());
-          if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-            break;
-
-          // this will return the current audio frame that contains the packets
-          // which are left over from last fillage
-          reference_audio_frame = process_audio(std::move(reference_audio_frame), *audio_read_frame);
-          audio_read_frame->unref();
-        }
+      ret = libav_context_->frame_from_decoder<video>(vframe);
+      if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        video_pool_->return_frame(vframe);
+        break;
       }
-      libav_context_->packet_finished();
+      if (vframe->raw()->format != AV_PIX_FMT_YUV420P) {
+        video_pool_->return_frame(vframe);
+        std::cerr << "Bad video frame format" << std::endl;
+        break;
+      }
+      queue_video_frame(std::make_unique<frame_from_pool<frame>>(vframe, *video_pool_, [](frame* f) { f->unref(); }));
     }
   }
-  // All capture_loop stack variables deleted before checking reason for exit
-  capture_loop_exited();
 }
 
 };  // namespace dolbyio::comms::sample
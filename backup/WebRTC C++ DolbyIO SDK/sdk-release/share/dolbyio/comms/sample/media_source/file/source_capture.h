@@ -14,9 +14,12 @@
 #include "comms/sample/media_source/file/libav_wrapper/avcontext.h"
 #include "comms/sample/media_source/file/source_context.h"
 #include "comms/sample/media_source/file/utils/audio_buffer.h"
+#include "comms/sample/media_source/file/utils/audio_converter.h"
 #include "comms/sample/media_source/file/utils/frame_pool.h"
 #include "comms/sample/media_source/file/utils/media_frame.h"
+#include "comms/sample/media_source/file/utils/spsc_queue.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -71,6 +74,8 @@ class file_source {
   int queue_audio_frame(audio_pool_frame_ptr&& value);
   int queue_video_frame(video_pool_frame_ptr&& value);
   void allocate_audio_frame_pool();
+  // nullptr when the pool stayed exhausted
+  audio_pool_frame_ptr get_audio_buffer();
   audio_pool_frame_ptr process_audio(audio_pool_frame_ptr&& curr_buff, frame& aframe);
 
   // Managing the capturing thread
@@ -79,8 +84,19 @@ class file_source {
   void capture_loop();
   void capture_loop_exited();
 
+  // The decoder threads capture_loop() feeds while it demuxes the file
+  void audio_decode_loop();
+  void video_decode_loop();
+  bool decoding_stopped() const { return file_state_.state() != file_state::PLAYING; }
+
+  // How far demuxing may run ahead of each decoder, enough for a video decode
+  // spike not to hold back the audio packets behind it
+  static constexpr std::size_t audio_packet_queue_size = 64;
+  static constexpr std::size_t video_packet_queue_size = 16;
+
   dolbyio::comms::plugin::injector_paced& injector_;
   std::unique_ptr<frame_pool<audio_buffer>> audio_pool_{};
+  audio_converter audio_converter_;
   std::unique_ptr<frame_pool<frame>> video_pool_{};
   std::unique_ptr<libav_context> libav_context_;
 
@@ -89,8 +105,9 @@ class file_source {
   std::vector<std::string>::iterator curr_file_;
 
   struct capture_state {
-    bool capture_audio = false;
-    bool capture_video = false;
+    // read by the demuxer without the capture lock
+    std::atomic<bool> capture_audio{false};
+    std::atomic<bool> capture_video{false};
     bool running = false;
     bool running_silence = false;
     bool looping = false;
@@ -111,6 +128,9 @@ class file_source {
   std::condition_variable wait_to_stop_;
   std::function<void()> capture_executor_;
 
+  spsc_queue<packet_ptr> audio_packets_{audio_packet_queue_size};
+  spsc_queue<packet_ptr> video_packets_{video_packet_queue_size};
+
   std::function<void(const file_source_status& status)> source_status_;
 };
 
@@ -9,6 +9,7 @@
  *                Copyright (C) 2022 by Dolby Laboratories.
  ***************************************************************************/
 
+#include <atomic>
 #include <string>
 
 namespace dolbyio::comms::sample {
@@ -26,7 +27,8 @@ struct audio_settings {
 struct file_state {
   enum state_change { PLAYING = 0, NEW, SEEK, STOP, PAUSE, RESUME };
 
-  state_change state() { return state_; }
+  // read without the capture lock by the pipeline threads
+  state_change state() const { return state_; }
   const std::string& name() { return name_; }
   void playing() { state_ = PLAYING; }
   void new_file(const std::string& file) {
@@ -41,7 +43,7 @@ struct file_state {
   audio_settings audio;
 
  private:
-  state_change state_ = STOP;
+  std::atomic<state_change> state_{STOP};
   std::string name_;
 };
 
@@ -12,6 +12,7 @@
 // added contents - 1130
 using namespace std;
 //#include "comms/sample/media_source/file/utils/AudioFileIf.h"
+#include <algorithm>
 #include <iostream>
 //using std::cout;
 //using std::endl;
@@ -54,6 +55,18 @@ void audio_buffer::push(int16_t value) {
     data_[index_++] = value;
 }
 
+int audio_buffer::frames_free() const {
+  return (size_ - index_) / channels_;
+}
+
+int16_t* audio_buffer::write_position() {
+  return data_.get() + index_;
+}
+
+void audio_buffer::commit(int frames) {
+  index_ = std::min(size_, index_ + frames * channels_);
+}
+
 bool audio_buffer::full() {
   return index_ == size_;
 }
@@ -21,6 +21,12 @@ class audio_buffer {
   bool full();
   void reset();
 
+  // Bulk writes: up to frames_free() interleaved frames go to
+  // write_position(), commit() then counts them as pushed.
+  int frames_free() const;
+  int16_t* write_position();
+  void commit(int frames);
+
   const int16_t* data() const;
   int sample_rate() const;
   int channels() const;
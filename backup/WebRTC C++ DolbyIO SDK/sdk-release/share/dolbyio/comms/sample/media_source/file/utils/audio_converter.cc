@@ -0,0 +1,259 @@
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+#include "comms/sample/media_source/file/utils/audio_converter.h"
+
+#include "comms/sample/media_source/file/utils/sample_convert.h"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace dolbyio::comms::sample {
+
+namespace {
+
+constexpr uint64_t left_channels = AV_CH_FRONT_LEFT | AV_CH_FRONT_LEFT_OF_CENTER | AV_CH_BACK_LEFT | AV_CH_SIDE_LEFT |
+                                   AV_CH_TOP_FRONT_LEFT | AV_CH_TOP_BACK_LEFT | AV_CH_STEREO_LEFT | AV_CH_WIDE_LEFT |
+                                   AV_CH_SURROUND_DIRECT_LEFT;
+constexpr uint64_t right_channels = AV_CH_FRONT_RIGHT | AV_CH_FRONT_RIGHT_OF_CENTER | AV_CH_BACK_RIGHT |
+                                    AV_CH_SIDE_RIGHT | AV_CH_TOP_FRONT_RIGHT | AV_CH_TOP_BACK_RIGHT |
+                                    AV_CH_STEREO_RIGHT | AV_CH_WIDE_RIGHT | AV_CH_SURROUND_DIRECT_RIGHT;
+constexpr uint64_t lfe_channels = AV_CH_LOW_FREQUENCY | AV_CH_LOW_FREQUENCY_2;
+constexpr uint64_t main_channels = AV_CH_FRONT_LEFT | AV_CH_FRONT_RIGHT | AV_CH_FRONT_CENTER | AV_CH_STEREO_LEFT |
+                                   AV_CH_STEREO_RIGHT;
+constexpr float minus_3db = 0.70710678f;
+
+int count_channels(uint64_t layout) {
+  int count = 0;
+  for (; layout; layout &= layout - 1)
+    ++count;
+  return count;
+}
+
+// what av_get_default_channel_layout() picks for these counts, kept here so
+// the converter only needs the libavutil headers
+uint64_t default_layout(int channels) {
+  switch (channels) {
+    case 1:
+      return AV_CH_LAYOUT_MONO;
+    case 2:
+      return AV_CH_LAYOUT_STEREO;
+    case 3:
+      return AV_CH_LAYOUT_2POINT1;
+    case 4:
+      return AV_CH_LAYOUT_4POINT0;
+    case 5:
+      return AV_CH_LAYOUT_5POINT0_BACK;
+    case 6:
+      return AV_CH_LAYOUT_5POINT1_BACK;
+    case 7:
+      return AV_CH_LAYOUT_6POINT1;
+    case 8:
+      return AV_CH_LAYOUT_7POINT1;
+    case 16:
+      return AV_CH_LAYOUT_HEXADECAGONAL;
+    default:
+      return 0;
+  }
+}
+
+bool is_planar(AVSampleFormat format) {
+  return format == AV_SAMPLE_FMT_S16P || format == AV_SAMPLE_FMT_S32P || format == AV_SAMPLE_FMT_FLTP ||
+         format == AV_SAMPLE_FMT_DBLP;
+}
+
+// the channel of the layout at position index
+uint64_t channel_at(uint64_t layout, int index) {
+  for (; layout; layout &= layout - 1) {
+    if (index-- == 0)
+      return layout & (~layout + 1);
+  }
+  return 0;
+}
+
+// Converts count samples of one packed or planar channel, stride apart.
+template <typename T>
+void to_float(const T* src, int stride, int count, float scale, float* dst) {
+  for (int i = 0; i < count; ++i)
+    dst[i] = static_cast<float>(src[i * stride] * scale);
+}
+
+}  // namespace
+
+bool audio_converter::matches(int format, int channels, uint64_t channel_layout, int out_channels) const {
+  return format == format_ && channels == channels_ && channel_layout == channel_layout_ &&
+         out_channels == out_channels_;
+}
+
+bool audio_converter::configure(int format, int channels, uint64_t channel_layout, int out_channels) {
+  switch (format) {
+    case AV_SAMPLE_FMT_S16:
+    case AV_SAMPLE_FMT_S16P:
+    case AV_SAMPLE_FMT_S32:
+    case AV_SAMPLE_FMT_S32P:
+    case AV_SAMPLE_FMT_FLT:
+    case AV_SAMPLE_FMT_FLTP:
+    case AV_SAMPLE_FMT_DBL:
+    case AV_SAMPLE_FMT_DBLP:
+      break;
+    default:
+      return false;
+  }
+  if (channels < 1 || out_channels < 1)
+    return false;
+
+  format_ = static_cast<AVSampleFormat>(format);
+  channels_ = channels;
+  channel_layout_ = channel_layout;
+  out_channels_ = out_channels;
+  mix_ = channels_ != out_channels_;
+  if (mix_)
+    build_mix_matrix();
+
+  scratch_.assign(static_cast<size_t>(channels_ + out_channels_) * block_frames, 0.0f);
+  in_planes_.assign(channels_, nullptr);
+  out_planes_.resize(out_channels_);
+  for (int ch = 0; ch < out_channels_; ++ch)
+    out_planes_[ch] = scratch_.data() + static_cast<size_t>(channels_ + ch) * block_frames;
+  return true;
+}
+
+void audio_converter::build_mix_matrix() {
+  // files often leave the layout unset, assume the usual one for the count
+  uint64_t layout = channel_layout_;
+  if (count_channels(layout) != channels_)
+    layout = default_layout(channels_);
+
+  matrix_.assign(static_cast<size_t>(out_channels_) * channels_, 0.0f);
+  for (int in = 0; in < channels_; ++in) {
+    const uint64_t channel = channel_at(layout, in);
+    if (channel & lfe_channels)
+      continue;
+    if (out_channels_ == 1) {
+      matrix_[in] = (channel & main_channels) || !channel ? 1.0f : minus_3db;
+    } else if (channels_ == 1) {
+      // upmix, the same signal in every channel
+      for (int out = 0; out < out_channels_; ++out)
+        matrix_[out * channels_] = 1.0f;
+    } else if (channel & left_channels) {
+      matrix_[in] = channel & main_channels ? 1.0f : minus_3db;
+    } else if (channel & right_channels) {
+      matrix_[channels_ + in] = channel & main_channels ? 1.0f : minus_3db;
+    } else if (channel) {
+      // centers go to both sides
+      matrix_[in] = minus_3db;
+      matrix_[channels_ + in] = minus_3db;
+    } else if (in < out_channels_) {
+      // nothing known about it, keep it where it is
+      matrix_[in * channels_ + in] = 1.0f;
+    }
+  }
+
+  // scale down so summing all channels at full scale cannot clip
+  float loudest = 1.0f;
+  for (int out = 0; out < out_channels_; ++out) {
+    float sum = 0.0f;
+    for (int in = 0; in < channels_; ++in)
+      sum += matrix_[out * channels_ + in];
+    loudest = std::max(loudest, sum);
+  }
+  for (float& gain : matrix_)
+    gain /= loudest;
+}
+
+void audio_converter::to_planar_float(const uint8_t* const* data, int offset, int frames) {
+  const bool planar = is_planar(format_);
+  const int stride = planar ? 1 : channels_;
+  for (int ch = 0; ch < channels_; ++ch) {
+    const size_t first = planar ? offset : static_cast<size_t>(offset) * channels_ + ch;
+    const uint8_t* plane = data[planar ? ch : 0];
+    float* dst = scratch_.data() + static_cast<size_t>(ch) * block_frames;
+    in_planes_[ch] = dst;
+
+    switch (format_) {
+      case AV_SAMPLE_FMT_FLTP:
+        in_planes_[ch] = reinterpret_cast<const float*>(plane) + first;
+        break;
+      case AV_SAMPLE_FMT_S16P:
+        s16_to_float(reinterpret_cast<const int16_t*>(plane) + first, frames, dst);
+        break;
+      case AV_SAMPLE_FMT_S16:
+        to_float(reinterpret_cast<const int16_t*>(plane) + first, stride, frames, 1.0f / 32768.0f, dst);
+        break;
+      case AV_SAMPLE_FMT_S32:
+      case AV_SAMPLE_FMT_S32P:
+        to_float(reinterpret_cast<const int32_t*>(plane) + first, stride, frames, 1.0f / 2147483648.0f, dst);
+        break;
+      case AV_SAMPLE_FMT_FLT:
+        to_float(reinterpret_cast<const float*>(plane) + first, stride, frames, 1.0f, dst);
+        break;
+      case AV_SAMPLE_FMT_DBL:
+      case AV_SAMPLE_FMT_DBLP:
+        to_float(reinterpret_cast<const double*>(plane) + first, stride, frames, 1.0, dst);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void audio_converter::convert(const uint8_t* const* data, int offset, int frames, int16_t* dst) {
+  if (!mix_) {
+    // single pass when the samples only need a new type or interleaving
+    if (format_ == AV_SAMPLE_FMT_S16) {
+      std::memcpy(dst, reinterpret_cast<const int16_t*>(data[0]) + static_cast<size_t>(offset) * channels_,
+                  static_cast<size_t>(frames) * channels_ * sizeof(int16_t));
+      return;
+    }
+    if (format_ == AV_SAMPLE_FMT_S16P) {
+      for (int ch = 0; ch < channels_; ++ch) {
+        const int16_t* src = reinterpret_cast<const int16_t*>(data[ch]) + offset;
+        for (int i = 0; i < frames; ++i)
+          dst[i * channels_ + ch] = src[i];
+      }
+      return;
+    }
+    if (format_ == AV_SAMPLE_FMT_FLT) {
+      // already interleaved, convert it as one long mono channel
+      const float* samples = reinterpret_cast<const float*>(data[0]);
+      planar_float_to_interleaved_s16(&samples, 1, offset * channels_, frames * channels_, dst);
+      return;
+    }
+    if (format_ == AV_SAMPLE_FMT_FLTP) {
+      planar_float_to_interleaved_s16(reinterpret_cast<const float* const*>(data), channels_, offset, frames, dst);
+      return;
+    }
+  }
+
+  for (int done = 0; done < frames; done += block_frames) {
+    const int count = std::min(block_frames, frames - done);
+    to_planar_float(data, offset + done, count);
+
+    const float* const* planes = in_planes_.data();
+    if (mix_) {
+      for (int out = 0; out < out_channels_; ++out) {
+        std::fill_n(out_planes_[out], count, 0.0f);
+        for (int in = 0; in < channels_; ++in) {
+          const float gain = matrix_[out * channels_ + in];
+          if (gain != 0.0f)
+            mix_add(in_planes_[in], gain, count, out_planes_[out]);
+        }
+      }
+      planes = out_planes_.data();
+    }
+    planar_float_to_interleaved_s16(planes, out_channels_, 0, count, dst + static_cast<size_t>(done) * out_channels_);
+  }
+}
+
+};  // namespace dolbyio::comms::sample
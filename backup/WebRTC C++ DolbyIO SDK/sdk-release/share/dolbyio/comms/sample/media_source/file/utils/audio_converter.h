@@ -0,0 +1,59 @@
+#pragma once
+
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+extern "C" {
+#include <libavutil/samplefmt.h>
+}
+
+#include <cstdint>
+#include <vector>
+
+namespace dolbyio::comms::sample {
+
+// Turns whatever the audio decoder produces (s16, s32, float or double,
+// packed or planar, any channel layout) into the interleaved int16 the
+// injector takes. Same channel count s16 and float, packed or planar, are
+// converted in a single pass, everything else goes through planar float and
+// a mixing matrix built from the channel layout.
+class audio_converter {
+ public:
+  // The injector takes mono and stereo, anything wider is downmixed to stereo.
+  static int output_channels(int channels) { return channels > 2 ? 2 : channels; }
+
+  // Prepares for frames of this format, allocates. False for sample formats
+  // libavcodec does not decode to.
+  bool configure(int format, int channels, uint64_t channel_layout, int out_channels);
+  bool matches(int format, int channels, uint64_t channel_layout, int out_channels) const;
+
+  // Converts frames frames, starting at frame offset of the decoded data, to
+  // out_channels interleaved samples each at dst.
+  void convert(const uint8_t* const* data, int offset, int frames, int16_t* dst);
+
+ private:
+  // frames converted to planar float at a time
+  static constexpr int block_frames = 256;
+
+  void build_mix_matrix();
+  void to_planar_float(const uint8_t* const* data, int offset, int frames);
+
+  AVSampleFormat format_ = AV_SAMPLE_FMT_NONE;
+  int channels_ = 0;
+  uint64_t channel_layout_ = 0;
+  int out_channels_ = 0;
+  bool mix_ = false;
+
+  std::vector<float> matrix_;  // out_channels_ rows of channels_ gains
+  std::vector<float> scratch_;
+  std::vector<const float*> in_planes_;
+  std::vector<float*> out_planes_;
+};
+
+};  // namespace dolbyio::comms::sample
@@ -0,0 +1,142 @@
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+#include "comms/sample/media_source/file/utils/sample_convert.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLE_CONVERT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SAMPLE_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace dolbyio::comms::sample {
+
+namespace {
+
+constexpr float full_scale = 32767.0f;
+
+inline int16_t to_s16(float value) {
+  // clamped first, so out of range and huge values cannot wrap
+  return static_cast<int16_t>(std::lrint(std::min(std::max(value * full_scale, -32768.0f), 32767.0f)));
+}
+
+#if SAMPLE_CONVERT_SSE2
+inline __m128i to_s32x4(const float* src) {
+  const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(full_scale));
+  return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(scaled, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f)));
+}
+
+// eight samples of one channel, the pack saturates to int16
+inline __m128i to_s16x8(const float* src) {
+  return _mm_packs_epi32(to_s32x4(src), to_s32x4(src + 4));
+}
+#elif SAMPLE_CONVERT_NEON
+inline int16x8_t to_s16x8(const float* src) {
+  const float32x4_t scale = vdupq_n_f32(full_scale);
+  const int32x4_t lo = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src), scale));
+  const int32x4_t hi = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + 4), scale));
+  return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+#endif
+
+// samples the vector paths handle, the rest goes through to_s16()
+int convert_mono(const float* src, int frames, int16_t* dst) {
+  int i = 0;
+#if SAMPLE_CONVERT_SSE2
+  for (; i + 8 <= frames; i += 8)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), to_s16x8(src + i));
+#elif SAMPLE_CONVERT_NEON
+  for (; i + 8 <= frames; i += 8)
+    vst1q_s16(dst + i, to_s16x8(src + i));
+#endif
+  return i;
+}
+
+int convert_stereo(const float* left, const float* right, int frames, int16_t* dst) {
+  int i = 0;
+#if SAMPLE_CONVERT_SSE2
+  for (; i + 8 <= frames; i += 8) {
+    const __m128i l = to_s16x8(left + i);
+    const __m128i r = to_s16x8(right + i);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_unpacklo_epi16(l, r));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+  }
+#elif SAMPLE_CONVERT_NEON
+  for (; i + 8 <= frames; i += 8)
+    vst2q_s16(dst + 2 * i, int16x8x2_t{{to_s16x8(left + i), to_s16x8(right + i)}});
+#endif
+  return i;
+}
+
+}  // namespace
+
+void s16_to_float(const int16_t* src, int count, float* dst) {
+  constexpr float scale = 1.0f / 32768.0f;
+  int i = 0;
+#if SAMPLE_CONVERT_SSE2
+  for (; i + 8 <= count; i += 8) {
+    const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // each sample in the upper half of a 32 bit lane, shifted back down with its sign
+    const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);
+    const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), _mm_set1_ps(scale)));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), _mm_set1_ps(scale)));
+  }
+#elif SAMPLE_CONVERT_NEON
+  for (; i + 8 <= count; i += 8) {
+    const int16x8_t in = vld1q_s16(src + i);
+    vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(in))), scale));
+    vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(in))), scale));
+  }
+#endif
+  for (; i < count; ++i)
+    dst[i] = src[i] * scale;
+}
+
+void mix_add(const float* src, float gain, int count, float* dst) {
+  int i = 0;
+#if SAMPLE_CONVERT_SSE2
+  const __m128 g = _mm_set1_ps(gain);
+  for (; i + 4 <= count; i += 4)
+    _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+#elif SAMPLE_CONVERT_NEON
+  for (; i + 4 <= count; i += 4)
+    vst1q_f32(dst + i, vmlaq_n_f32(vld1q_f32(dst + i), vld1q_f32(src + i), gain));
+#endif
+  for (; i < count; ++i)
+    dst[i] += gain * src[i];
+}
+
+void planar_float_to_interleaved_s16(const float* const* src, int channels, int offset, int frames, int16_t* dst) {
+  if (channels == 1) {
+    const float* mono = src[0] + offset;
+    for (int i = convert_mono(mono, frames, dst); i < frames; ++i)
+      dst[i] = to_s16(mono[i]);
+  } else if (channels == 2) {
+    const float* left = src[0] + offset;
+    const float* right = src[1] + offset;
+    for (int i = convert_stereo(left, right, frames, dst); i < frames; ++i) {
+      dst[2 * i] = to_s16(left[i]);
+      dst[2 * i + 1] = to_s16(right[i]);
+    }
+  } else {
+    for (int ch = 0; ch < channels; ++ch) {
+      const float* in = src[ch] + offset;
+      for (int i = 0; i < frames; ++i)
+        dst[i * channels + ch] = to_s16(in[i]);
+    }
+  }
+}
+
+};  // namespace dolbyio::comms::sample
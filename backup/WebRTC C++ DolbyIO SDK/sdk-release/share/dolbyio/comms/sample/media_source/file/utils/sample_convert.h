@@ -0,0 +1,28 @@
+#pragma once
+
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+#include <cstdint>
+
+namespace dolbyio::comms::sample {
+
+// Converts frames samples from src[ch] + offset of every channel to int16,
+// rounding to nearest and saturating at full scale instead of wrapping, and
+// writes them interleaved to dst. Mono and stereo use SSE2 on x86 and NEON
+// on arm64, other channel counts convert one channel at a time.
+void planar_float_to_interleaved_s16(const float* const* src, int channels, int offset, int frames, int16_t* dst);
+
+// dst[i] = src[i] / 32768 for count samples.
+void s16_to_float(const int16_t* src, int count, float* dst);
+
+// dst[i] += gain * src[i] for count samples, one entry of a mixing matrix.
+void mix_add(const float* src, float gain, int count, float* dst);
+
+};  // namespace dolbyio::comms::sample
@@ -0,0 +1,131 @@
+#pragma once
+
+/***************************************************************************
+ * This program is licensed by the accompanying "license" file. This file is
+ * distributed "AS IS" AND WITHOUT WARRANTY OF ANY KIND WHATSOEVER, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ *
+ *                Copyright (C) 2022 by Dolby Laboratories.
+ ***************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace dolbyio::comms::sample {
+
+// Bounded queue between exactly one producer and one consumer thread, used
+// to hand demuxed packets to the decoder threads. try_push() and try_pop()
+// are lock free. The blocking calls only take the mutex to sleep while the
+// queue is full or empty, and wake up every poll_interval to ask the caller's
+// stop() whether to give up, so a state change never needs to reach them.
+template <typename T>
+class spsc_queue {
+ public:
+  static constexpr std::chrono::milliseconds poll_interval{10};
+
+  explicit spsc_queue(std::size_t capacity) : capacity_(capacity), slots_(std::make_unique<T[]>(capacity)) {}
+
+  // Producer side. Moves from value only when there was room for it.
+  bool try_push(T& value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == capacity_)
+      return false;
+    slots_[tail % capacity_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    wake();
+    return true;
+  }
+
+  // Producer side. Waits until a push cannot fail, false when stop() said so first.
+  template <typename Stop>
+  bool wait_for_space(Stop&& stop) {
+    return wait([this]() { return size() < capacity_; }, stop);
+  }
+
+  // Producer side, no more pushes until reopen().
+  void close() {
+    closed_ = true;
+    wake();
+  }
+
+  // Consumer side.
+  bool try_pop(T& value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (tail_.load(std::memory_order_acquire) == head)
+      return false;
+    value = std::move(slots_[head % capacity_]);
+    head_.store(head + 1, std::memory_order_release);
+    wake();
+    return true;
+  }
+
+  // Consumer side. Waits for the next value, false once stop() says so or
+  // the queue was closed and is empty.
+  template <typename Stop>
+  bool pop(T& value, Stop&& stop) {
+    for (;;) {
+      if (stop())
+        return false;
+      if (try_pop(value))
+        return true;
+      if (closed_ && size() == 0)
+        return false;
+      wait([this]() { return size() > 0 || closed_; }, stop);
+    }
+  }
+
+  // Only while neither side runs: drops everything queued.
+  void clear() {
+    T value;
+    while (try_pop(value)) {
+    }
+  }
+
+  // Only while neither side runs.
+  void reopen() { closed_ = false; }
+
+  std::size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+
+ private:
+  template <typename Ready, typename Stop>
+  bool wait(Ready&& ready, Stop&& stop) {
+    while (!ready()) {
+      if (stop())
+        return false;
+      std::unique_lock<std::mutex> lock(lock_);
+      ++waiters_;
+      // pairs with wake(), either it sees the waiter or this sees its change
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!ready())
+        cond_.wait_for(lock, poll_interval);
+      --waiters_;
+    }
+    return true;
+  }
+
+  void wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_ > 0) {
+      // taking the lock orders the notify after the waiter started waiting
+      std::lock_guard<std::mutex> lock(lock_);
+      cond_.notify_all();
+    }
+  }
+
+  const std::size_t capacity_;
+  std::unique_ptr<T[]> slots_;
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  std::atomic<bool> closed_{false};
+
+  std::mutex lock_;
+  std::condition_variable cond_;
+  std::atomic<int> waiters_{0};
+};
+
+};  // namespace dolbyio::comms::sample
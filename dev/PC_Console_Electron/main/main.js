@@ -4,18 +4,26 @@ const path = require('path')
 const dgram = require('dgram');
 const WebSocket = require('ws');
 
-const udpServer = dgram.createSocket('udp4');
-const wss = new WebSocket.Server({ port: 8081 });
+// the renderer hands audio to the worklet through a SharedArrayBuffer when the
+// native udp_ring receiver is built, and that receiver owns port 41234 itself
+app.commandLine.appendSwitch('enable-features', 'SharedArrayBuffer');
+const udpRing = require('../native/udp_ring');
 
-udpServer.on('message', (msg, info) => {
-    wss.clients.forEach(client => {
-        if (client.readyState === WebSocket.OPEN) {
-            client.send(msg);
-        }
+// otherwise fall back to relaying the Sender's datagrams over a WebSocket
+if (!udpRing) {
+    const udpServer = dgram.createSocket('udp4');
+    const wss = new WebSocket.Server({ port: 8081 });
+
+    udpServer.on('message', (msg, info) => {
+        wss.clients.forEach(client => {
+            if (client.readyState === WebSocket.OPEN) {
+                client.send(msg);
+            }
+        });
     });
-});
 
-udpServer.bind(41234);
+    udpServer.bind(41234);
+}
 
 // const { initializeApp } = require('firebase/app');
 // const firebaseConfig = {
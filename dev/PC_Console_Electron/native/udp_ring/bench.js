@@ -0,0 +1,157 @@
+// bench.js
+//
+// Headless benchmark of the native receiver, no Electron window needed:
+//   node bench.js [datagrams]
+// or, against the Electron build of the addon:
+//   ELECTRON_RUN_AS_NODE=1 npx electron native/udp_ring/bench.js
+//
+// Sends loopback datagrams of 512 floats (what the Sender writes) to the
+// addon, and a worker drains the shared ring with Atomics the way the
+// AudioWorklet does. Every datagram carries its sequence number in the first
+// sample, so the worker can tell how long each one took.
+//   wake latency: one datagram at a time with the receive thread idle in
+//                 poll(), time from send() until the worker sees it in the ring
+//   throughput:   datagrams sent back to back, what reached the ring per second
+
+const { Worker, isMainThread, workerData } = require('worker_threads');
+const dgram = require('dgram');
+
+const kPort = 41299;
+const kFrames = 512;
+const kPings = 2000;
+const kBatch = 32;
+// the worker's nap when the ring is empty, adds up to this much to the wake latency
+const kIdleMs = 0.05;
+
+const now = () => performance.timeOrigin + performance.now();
+
+// worker: drains whole datagrams and stamps each with the time it showed up
+function drain() {
+    const { sab, headerBytes, sendTimes, latencies, control } = workerData;
+    const header = new Int32Array(sab, 0, headerBytes / 4);
+    const length = (sab.byteLength - headerBytes) / 4;
+    const samples = new Float32Array(sab, headerBytes, length);
+    const sent = new Float64Array(sendTimes);
+    const latency = new Float64Array(latencies);
+    const state = new Int32Array(control);   // [0] stop, [1] datagrams drained
+
+    while (Atomics.load(state, 0) === 0) {
+        const writeIndex = Atomics.load(header, 0);
+        let readIndex = Atomics.load(header, 1);
+        if (readIndex === writeIndex) {
+            // sleep like the worklet between quanta, a busy loop would starve the
+            // receive thread on a machine with few cores
+            Atomics.wait(state, 0, 0, kIdleMs);
+            continue;
+        }
+        const seen = now();
+        // the ring is a multiple of 512, so datagrams never straddle its end
+        while (readIndex !== writeIndex) {
+            const seq = samples[readIndex];
+            latency[seq] = seen - sent[seq];
+            readIndex = (readIndex + kFrames) % length;
+            Atomics.add(state, 1, 1);
+        }
+        Atomics.store(header, 1, readIndex);
+        Atomics.notify(state, 1);
+    }
+}
+
+function percentile(sorted, p) {
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+async function main() {
+    const udpRing = require('./index');
+    if (!udpRing) {
+        process.exit(1);
+    }
+
+    const count = parseInt(process.argv[2] || '20000', 10);
+    const ringLength = kFrames * 1000;
+    const sab = new SharedArrayBuffer(udpRing.RING_HEADER_BYTES + ringLength * 4);
+    const header = new Int32Array(sab, 0, udpRing.RING_HEADER_BYTES / 4);
+    const receiver = new udpRing.Receiver(kPort, new Int32Array(sab));
+
+    const shared = {
+        sendTimes: new SharedArrayBuffer((kPings + count) * 8),
+        latencies: new SharedArrayBuffer((kPings + count) * 8),
+        control: new SharedArrayBuffer(8),
+    };
+    const sent = new Float64Array(shared.sendTimes);
+    const latency = new Float64Array(shared.latencies);
+    const state = new Int32Array(shared.control);
+    const worker = new Worker(__filename, {
+        workerData: { sab, headerBytes: udpRing.RING_HEADER_BYTES, ...shared },
+    });
+
+    const socket = dgram.createSocket('udp4');
+    const send = (seq) => new Promise((resolve) => {
+        const payload = new Float32Array(kFrames);
+        payload[0] = seq;
+        sent[seq] = now();
+        socket.send(Buffer.from(payload.buffer), kPort, '127.0.0.1', resolve);
+    });
+    const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+    // wake latency, one datagram in flight at a time
+    await sleep(100);
+    for (let seq = 0; seq < kPings; ++seq) {
+        const drained = Atomics.load(state, 1);
+        await send(seq);
+        Atomics.wait(state, 1, drained, 1000);
+        await sleep(1);
+    }
+    const wake = Array.from(latency.subarray(0, kPings)).filter((ms) => ms > 0).sort((a, b) => a - b);
+    const us = (ms) => (ms * 1000).toFixed(0) + ' us';
+    console.log(`wake latency over ${wake.length}/${kPings} datagrams: p50 ${us(percentile(wake, 0.5))}, `
+        + `p99 ${us(percentile(wake, 0.99))}, max ${us(wake[wake.length - 1])}`);
+
+    // throughput, batches of datagrams back to back
+    const packetsBefore = Atomics.load(header, 3);
+    const start = now();
+    for (let seq = kPings; seq < kPings + count; seq += kBatch) {
+        const batch = [];
+        for (let i = seq; i < Math.min(seq + kBatch, kPings + count); ++i) {
+            batch.push(send(i));
+        }
+        await Promise.all(batch);
+    }
+    const sendEnd = now();
+
+    // loopback may drop some under load, stop once nothing arrived for 200 ms
+    let drained = Atomics.load(state, 1);
+    for (let idle = 0; idle < 200 && drained < kPings + count; idle += 10) {
+        await sleep(10);
+        const latest = Atomics.load(state, 1);
+        if (latest !== drained) {
+            drained = latest;
+            idle = 0;
+        }
+    }
+    let last = 0;
+    for (let seq = kPings; seq < kPings + count; ++seq) {
+        if (latency[seq] > 0) {
+            last = Math.max(last, sent[seq] + latency[seq]);
+        }
+    }
+
+    const received = Atomics.load(header, 3) - packetsBefore;
+    const delivered = drained - kPings;
+    const seconds = ((last || sendEnd) - start) / 1000;
+    console.log(`throughput: ${count} sent, ${received} received, ${delivered} in the ring, `
+        + `${Atomics.load(header, 2)} overruns, ${(delivered / seconds).toFixed(0)} datagrams/s `
+        + `(${(delivered * kFrames * 4 / seconds / 1e6).toFixed(1)} MB/s, `
+        + `${(delivered * kFrames / seconds / 48000).toFixed(0)}x a 48 kHz mono stream)`);
+
+    Atomics.store(state, 0, 1);
+    await worker.terminate();
+    socket.close();
+    receiver.close();
+}
+
+if (isMainThread) {
+    main();
+} else {
+    drain();
+}
@@ -0,0 +1,17 @@
+{
+  "targets": [
+    {
+      "target_name": "udp_ring",
+      "sources": ["udp_ring.cc"],
+      "cflags_cc": ["-O2", "-std=c++17"],
+      "defines": ["NAPI_VERSION=8"],
+      "xcode_settings": {
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17",
+        "GCC_OPTIMIZATION_LEVEL": "2"
+      },
+      "conditions": [
+        ["OS=='win'", { "libraries": ["ws2_32.lib"] }]
+      ]
+    }
+  ]
+}
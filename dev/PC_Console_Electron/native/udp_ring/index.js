@@ -0,0 +1,14 @@
+// index.js
+
+// load the native receiver, or null when it has not been built so callers can
+// fall back to the WebSocket path
+function loadUdpRing() {
+    try {
+        return require('./build/Release/udp_ring.node');
+    } catch (err) {
+        console.warn("udp_ring native addon not available:", err.message);
+        return null;
+    }
+}
+
+module.exports = loadUdpRing();
@@ -0,0 +1,284 @@
+// udp_ring.cc
+//
+// Receives the Sender plugin's UDP stream natively and writes the samples
+// straight into a SharedArrayBuffer that the AudioWorklet reads with Atomics.
+// This replaces the UDP -> WebSocket -> port.postMessage -> push() chain.
+//
+// Shared memory layout (must match SharedRingBuffer in audio-processor.js):
+//   Int32[0]  write index  (only written here)
+//   Int32[1]  read index   (only written by the worklet)
+//   Int32[2]  overrun counter, packets dropped because the ring was full
+//   Int32[3]  packet counter
+//   Float32[RING_HEADER_BYTES / 4 ...]  sample data, `length` floats
+//
+// Indices run in [0, length) and the ring is empty when they are equal, so one
+// slot is always kept free, exactly like the worklet's RingBuffer.
+
+#include <node_api.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+#define CLOSE_SOCKET closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define CLOSE_SOCKET ::close
+#endif
+
+namespace {
+
+constexpr int kHeaderInts = 4;
+constexpr int kHeaderBytes = kHeaderInts * sizeof(int32_t);
+// the Sender writes 512 floats per datagram, leave room for larger blocks
+constexpr int kMaxDatagramBytes = 65536;
+
+enum HeaderSlot { kWriteIdx = 0, kReadIdx = 1, kOverruns = 2, kPackets = 3 };
+
+class UdpRing
+{
+public:
+    UdpRing(int32_t* shared, size_t sharedBytes)
+        : m_header(reinterpret_cast<std::atomic<int32_t>*>(shared)),
+          m_data(reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(shared) + kHeaderBytes)),
+          m_length((int32_t) ((sharedBytes - kHeaderBytes) / sizeof(float)))
+    {
+    }
+
+    ~UdpRing() { close(); }
+
+    bool open(int port)
+    {
+#ifdef _WIN32
+        WSADATA wsa;
+        WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+        m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_socket == INVALID_SOCKET)
+            return false;
+
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons((uint16_t) port);
+        if (bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+        {
+            CLOSE_SOCKET(m_socket);
+            m_socket = INVALID_SOCKET;
+            return false;
+        }
+
+        m_running = true;
+        m_thread = std::thread([this]() { receiveLoop(); });
+        return true;
+    }
+
+    void close()
+    {
+        m_running = false;
+        if (m_thread.joinable())
+            m_thread.join();
+        if (m_socket != INVALID_SOCKET)
+        {
+            CLOSE_SOCKET(m_socket);
+            m_socket = INVALID_SOCKET;
+        }
+    }
+
+    int32_t length() const { return m_length; }
+
+private:
+    void receiveLoop()
+    {
+        alignas(16) uint8_t datagram[kMaxDatagramBytes];
+
+        while (m_running)
+        {
+            // wake up regularly so close() never waits on a silent socket
+#ifdef _WIN32
+            WSAPOLLFD pfd { m_socket, POLLRDNORM, 0 };
+            if (WSAPoll(&pfd, 1, 50) <= 0)
+                continue;
+#else
+            pollfd pfd { m_socket, POLLIN, 0 };
+            if (poll(&pfd, 1, 50) <= 0)
+                continue;
+#endif
+            const int bytes = (int) recv(m_socket, reinterpret_cast<char*>(datagram), sizeof(datagram), 0);
+            if (bytes <= 0)
+                continue;
+
+            write(reinterpret_cast<const float*>(datagram), bytes / (int) sizeof(float));
+        }
+    }
+
+    // single producer: copy the whole datagram in at most two segments, then
+    // publish it with one release store of the write index
+    void write(const float* samples, int32_t numSamples)
+    {
+        const int32_t writeIdx = m_header[kWriteIdx].load(std::memory_order_relaxed);
+        const int32_t readIdx = m_header[kReadIdx].load(std::memory_order_acquire);
+
+        int32_t used = writeIdx - readIdx;
+        if (used < 0)
+            used += m_length;
+        const int32_t space = m_length - 1 - used;
+
+        m_header[kPackets].fetch_add(1, std::memory_order_relaxed);
+        if (numSamples > space)
+        {
+            m_header[kOverruns].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const int32_t first = numSamples < m_length - writeIdx ? numSamples : m_length - writeIdx;
+        std::memcpy(m_data + writeIdx, samples, first * sizeof(float));
+        std::memcpy(m_data, samples + first, (numSamples - first) * sizeof(float));
+
+        int32_t next = writeIdx + numSamples;
+        if (next >= m_length)
+            next -= m_length;
+        m_header[kWriteIdx].store(next, std::memory_order_release);
+    }
+
+    std::atomic<int32_t>* m_header;
+    float* m_data;
+    int32_t m_length;
+
+    socket_t m_socket = INVALID_SOCKET;
+    std::atomic<bool> m_running { false };
+    std::thread m_thread;
+};
+
+struct Receiver
+{
+    UdpRing* ring = nullptr;
+    napi_ref sharedRef = nullptr;   // keeps the SharedArrayBuffer alive while the thread writes
+};
+
+void throwError(napi_env env, const char* message)
+{
+    napi_throw_error(env, nullptr, message);
+}
+
+void finalizeReceiver(napi_env env, void* data, void*)
+{
+    auto* receiver = static_cast<Receiver*>(data);
+    delete receiver->ring;
+    if (receiver->sharedRef)
+        napi_delete_reference(env, receiver->sharedRef);
+    delete receiver;
+}
+
+Receiver* unwrapThis(napi_env env, napi_callback_info info)
+{
+    napi_value self;
+    napi_get_cb_info(env, info, nullptr, nullptr, &self, nullptr);
+    Receiver* receiver = nullptr;
+    napi_unwrap(env, self, reinterpret_cast<void**>(&receiver));
+    return receiver;
+}
+
+// new Receiver(port, new Int32Array(sharedArrayBuffer))
+napi_value construct(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_value self;
+    napi_get_cb_info(env, info, &argc, args, &self, nullptr);
+
+    if (argc < 2)
+    {
+        throwError(env, "Receiver(port, Int32Array over a SharedArrayBuffer) expected");
+        return nullptr;
+    }
+
+    int32_t port = 0;
+    if (napi_get_value_int32(env, args[0], &port) != napi_ok)
+    {
+        throwError(env, "port must be a number");
+        return nullptr;
+    }
+
+    // N-API cannot read a SharedArrayBuffer directly, but a typed array view over it works
+    bool isTypedArray = false;
+    napi_is_typedarray(env, args[1], &isTypedArray);
+    if (! isTypedArray)
+    {
+        throwError(env, "second argument must be an Int32Array over the shared ring");
+        return nullptr;
+    }
+
+    napi_typedarray_type type;
+    size_t length = 0;
+    void* data = nullptr;
+    napi_value arrayBuffer;
+    size_t byteOffset = 0;
+    napi_get_typedarray_info(env, args[1], &type, &length, &data, &arrayBuffer, &byteOffset);
+    if (type != napi_int32_array || length * sizeof(int32_t) <= (size_t) kHeaderBytes + sizeof(float))
+    {
+        throwError(env, "shared ring is too small or not an Int32Array");
+        return nullptr;
+    }
+
+    auto* receiver = new Receiver();
+    receiver->ring = new UdpRing(static_cast<int32_t*>(data), length * sizeof(int32_t));
+    napi_create_reference(env, args[1], 1, &receiver->sharedRef);
+
+    if (! receiver->ring->open(port))
+    {
+        finalizeReceiver(env, receiver, nullptr);
+        throwError(env, "could not bind the UDP port");
+        return nullptr;
+    }
+
+    napi_wrap(env, self, receiver, finalizeReceiver, nullptr, nullptr);
+    return self;
+}
+
+napi_value closeReceiver(napi_env env, napi_callback_info info)
+{
+    if (Receiver* receiver = unwrapThis(env, info))
+        receiver->ring->close();
+    return nullptr;
+}
+
+napi_value getLength(napi_env env, napi_callback_info info)
+{
+    napi_value result;
+    Receiver* receiver = unwrapThis(env, info);
+    napi_create_int32(env, receiver ? receiver->ring->length() : 0, &result);
+    return result;
+}
+
+}  // namespace
+
+NAPI_MODULE_INIT()
+{
+    napi_property_descriptor methods[] = {
+        { "close", nullptr, closeReceiver, nullptr, nullptr, nullptr, napi_default, nullptr },
+        { "length", nullptr, getLength, nullptr, nullptr, nullptr, napi_default, nullptr },
+    };
+
+    napi_value receiverClass;
+    napi_define_class(env, "Receiver", NAPI_AUTO_LENGTH, construct, nullptr,
+                      sizeof(methods) / sizeof(methods[0]), methods, &receiverClass);
+    napi_set_named_property(env, exports, "Receiver", receiverClass);
+
+    napi_value headerBytes;
+    napi_create_int32(env, kHeaderBytes, &headerBytes);
+    napi_set_named_property(env, exports, "RING_HEADER_BYTES", headerBytes);
+
+    return exports;
+}
@@ -54,14 +54,53 @@ class RingBuffer {
     }
 }
 
+// Ring shared with the udp_ring native addon through a SharedArrayBuffer.
+// Same index layout as RingBuffer (one slot kept free, empty when equal), but
+// the indices live in an Int32Array header so both sides use atomics:
+// [0] write index, [1] read index, [2] overruns, [3] packets.
+class SharedRingBuffer {
+    constructor(sab, headerBytes) {
+        this.header = new Int32Array(sab, 0, headerBytes / 4);
+        this.length = (sab.byteLength - headerBytes) / 4;
+        this.buffer = new Float32Array(sab, headerBytes, this.length);
+    }
+
+    size() {
+        const writeIndex = Atomics.load(this.header, 0);
+        const readIndex = Atomics.load(this.header, 1);
+        if (writeIndex < readIndex) {
+            return writeIndex + this.length - readIndex;
+        }
+        return writeIndex - readIndex;
+    }
+
+    // copy up to out.length samples in at most two segments, zero fill the rest
+    read(out) {
+        const readIndex = Atomics.load(this.header, 1);
+        const count = Math.min(out.length, this.size());
+        const first = Math.min(count, this.length - readIndex);
+        out.set(this.buffer.subarray(readIndex, readIndex + first), 0);
+        out.set(this.buffer.subarray(0, count - first), first);
+        out.fill(0, count);
+        Atomics.store(this.header, 1, (readIndex + count) % this.length);
+        return count;
+    }
+}
+
 class AudioProcessor extends AudioWorkletProcessor {
     constructor() {
         super();
         // the udp package is 512 samples length or 2048 in byte
         this.bufferSize = 512;
         this.ringBuffer = new RingBuffer(this.bufferSize * 1000); // Four times the buffer for some leeway
+        this.sharedRing = null;
         this.port.onmessage = (event) => {
             const data = event.data;
+            // the native receiver hands over its shared ring once, no more audio messages after that
+            if (data.sab) {
+                this.sharedRing = new SharedRingBuffer(data.sab, data.headerBytes);
+                return;
+            }
             // console.log(data);
             console.log("Received ", data.length, " samples");
             for (let i = 0; i < data.length; i++) {
@@ -72,6 +111,14 @@ class AudioProcessor extends AudioWorkletProcessor {
 
     process(inputs, outputs) {
         const output = outputs[0];
+        if (this.sharedRing) {
+            // the stream is mono, read it once and copy it to the other channels
+            this.sharedRing.read(output[0]);
+            for (let channel = 1; channel < output.length; channel++) {
+                output[channel].set(output[0]);
+            }
+            return true;
+        }
         for (let channel = 0; channel < output.length; channel++) {
             const outputChannel = output[channel];
             console.log("channel: ", channel, "available: ", this.ringBuffer.size());
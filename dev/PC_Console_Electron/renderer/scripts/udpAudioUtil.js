@@ -25,6 +25,17 @@ async function startUdpAudio() {
     document.addEventListener('click', resumeAudioContext);
     document.addEventListener('touchend', resumeAudioContext);
 
+    // prefer the native receiver: it writes straight into a ring shared with the worklet
+    const udpRing = require('../native/udp_ring');
+    if (udpRing) {
+        // the udp package is 512 samples, keep the same leeway as the worklet's own ring
+        const ringLength = 512 * 1000;
+        const sab = new SharedArrayBuffer(udpRing.RING_HEADER_BYTES + ringLength * 4);
+        window.udpReceiver = new udpRing.Receiver(41234, new Int32Array(sab));
+        processorNode.port.postMessage({ sab: sab, headerBytes: udpRing.RING_HEADER_BYTES });
+        return processedStream;
+    }
+
     const ws = new WebSocket('ws://localhost:8081');
     ws.binaryType = 'arraybuffer';
 
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    DelayLineBench.cpp
+    DelayLine against the per sample loop it replaced in processBlock.
+
+    Both delay a block of every channel by one second at 48 kHz, the old loop
+    the way it did before DelayLine (write a sample, read it back at a double
+    position, wrap with a branch), DelayLine as the processor calls it now.
+    Three cases, since DelayLine takes a different path for each:
+      integer   whole sample delay, two memcpy per channel
+      fixed     fractional delay that holds still, 4 tap FIR over the copy
+      gliding   delay ramping every sample, Farrow interpolation
+    The old loop does the same work in all three, so it is timed once per
+    size with a ramp. Printed in nanoseconds per sample and channel.
+
+    It needs no JUCE module beyond juce_audio_basics, so it also builds
+    against StandIn/JuceHeader.h without a JUCE checkout, which is how its
+    first figures were taken:
+      g++ -std=c++17 -O2 -IStandIn -I../Source DelayLineBench.cpp ../Source/DelayLine.cpp ../Source/FirKernel.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DelayLine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int kiSampleRate = 48000;
+    constexpr int kiMaxDelay = kiSampleRate;
+    constexpr float kfDelay = 0.5f * kiSampleRate + 0.37f;
+
+    // each case runs at least this long in wall time, repeated runs keep the fastest
+    constexpr double kdMinSeconds = 0.02;
+    constexpr int kiRuns = 3;
+
+    // the ring and write index processBlock kept before DelayLine
+    struct OldLoop
+    {
+        juce::AudioBuffer<float> m_fDelayBuffer;
+        int m_iBuffLenSample = 0;
+        int m_iWriteIdx = 0;
+
+        void prepare (int iNumChannels)
+        {
+            m_iBuffLenSample = kiMaxDelay + 2;
+            m_fDelayBuffer.setSize (iNumChannels, m_iBuffLenSample);
+            m_fDelayBuffer.clear();
+            m_iWriteIdx = 0;
+        }
+
+        void process (float* const* ppfChannels, int iNumChannels, int iNumSamples, const float* pfDelayRamp)
+        {
+            int wIdx = m_iWriteIdx;
+
+            for (int channel = 0; channel < iNumChannels; ++channel)
+            {
+                float* channelData = ppfChannels[channel];
+                float* delayData = m_fDelayBuffer.getWritePointer (channel);
+
+                wIdx = m_iWriteIdx;
+
+                for (int i = 0; i < iNumSamples; ++i)
+                {
+                    delayData[wIdx] = channelData[i];
+
+                    double fReadPos = wIdx - (double) pfDelayRamp[i];
+                    if (fReadPos < 0)
+                        fReadPos += m_iBuffLenSample;
+
+                    const int iRead0 = (int) fReadPos;
+                    const int iRead1 = iRead0 + 1 < m_iBuffLenSample ? iRead0 + 1 : 0;
+                    const float fFrac = (float) (fReadPos - iRead0);
+
+                    channelData[i] = delayData[iRead0] + fFrac * (delayData[iRead1] - delayData[iRead0]);
+
+                    wIdx++;
+                    if (wIdx >= m_iBuffLenSample)
+                        wIdx = 0;
+                }
+            }
+
+            m_iWriteIdx = wIdx;
+        }
+    };
+
+    enum class Case { integer, fixed, gliding };
+
+    // DelayLine the way processSubBlock drives it
+    void processDelayLine (DelayLine& line, float* const* ppfChannels, int iNumChannels, int iNumSamples,
+                           Case c, const float* pfDelayRamp)
+    {
+        for (int ch = 0; ch < iNumChannels; ++ch)
+        {
+            line.write (ch, ppfChannels[ch], iNumSamples);
+            switch (c)
+            {
+                case Case::integer: line.read (ch, ppfChannels[ch], iNumSamples, (int) kfDelay); break;
+                case Case::fixed:   line.readFractional (ch, ppfChannels[ch], iNumSamples, kfDelay); break;
+                case Case::gliding: line.readInterpolated (ch, ppfChannels[ch], iNumSamples, pfDelayRamp); break;
+            }
+        }
+        line.advance (iNumSamples);
+    }
+
+    // fastest of kiRuns, in ns per sample and channel
+    template <typename Process>
+    double time (int iNumChannels, int iNumSamples, Process&& process)
+    {
+        using Clock = std::chrono::steady_clock;
+        double dBest = 1.0e30;
+        for (int run = 0; run < kiRuns; ++run)
+        {
+            const auto start = Clock::now();
+            std::chrono::duration<double> elapsed {};
+            long long iBlocks = 0;
+            for (; elapsed.count() < kdMinSeconds; elapsed = Clock::now() - start)
+            {
+                // a batch between clock reads, so short blocks are not timing the clock
+                for (int b = 0; b < 16; ++b)
+                    process();
+                iBlocks += 16;
+            }
+            dBest = juce::jmin (dBest, elapsed.count() * 1.0e9 / ((double) iBlocks * iNumSamples * iNumChannels));
+        }
+        return dBest;
+    }
+}
+
+int main()
+{
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const int channelCounts[] = { 1, 2, 4, 8, 16 };
+
+    std::printf ("ns per sample and channel, 1 s ring at 48 kHz\n");
+    std::printf ("%6s %3s  %9s %9s %9s %9s  %7s %7s %7s\n", "block", "ch", "old loop", "integer", "fixed", "gliding",
+                 "x int", "x fixed", "x glide");
+
+    for (int iNumSamples : blockSizes)
+    {
+        for (int iNumChannels : channelCounts)
+        {
+            juce::AudioBuffer<float> buffer (iNumChannels, iNumSamples);
+            juce::Random random (1);
+            for (int ch = 0; ch < iNumChannels; ++ch)
+                for (int i = 0; i < iNumSamples; ++i)
+                    buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            // a glide of a sample per block, as the smoothed delay produces while it moves
+            std::vector<float> ramp ((size_t) iNumSamples);
+            for (int i = 0; i < iNumSamples; ++i)
+                ramp[(size_t) i] = kfDelay + (float) i / (float) iNumSamples;
+
+            OldLoop old;
+            old.prepare (iNumChannels);
+            const double dOld = time (iNumChannels, iNumSamples, [&]
+            {
+                old.process (buffer.getArrayOfWritePointers(), iNumChannels, iNumSamples, ramp.data());
+            });
+
+            double dNew[3];
+            for (Case c : { Case::integer, Case::fixed, Case::gliding })
+            {
+                DelayLine line;
+                line.prepare (iNumChannels, kiMaxDelay, iNumSamples);
+                dNew[(int) c] = time (iNumChannels, iNumSamples, [&]
+                {
+                    processDelayLine (line, buffer.getArrayOfWritePointers(), iNumChannels, iNumSamples, c, ramp.data());
+                });
+            }
+
+            std::printf ("%6d %3d  %9.2f %9.2f %9.2f %9.2f  %7.1f %7.1f %7.1f\n", iNumSamples, iNumChannels,
+                         dOld, dNew[0], dNew[1], dNew[2], dOld / dNew[0], dOld / dNew[1], dOld / dNew[2]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    InstantiationBench.cpp
+    Creates 100 instances of a plugin the way a host scanning or loading a
+    session does, and times each step per instance.
+
+    Linked against the sources of one plugin, it goes through that plugin's
+    createPluginFilter(), so the same file measures the Compensator, the
+    Sender and the receiver:
+      construct   what a plugin scan pays for every instance
+      prepare     the first prepareToPlay, where the network is opened now
+      destroy     straight after prepare, with connects still in flight
+    Printed as the mean and the slowest instance in milliseconds.
+
+    Still open: neither this file nor add_plugin_bench() has been compiled,
+    no JUCE checkout was available, so there are no timings yet. The plugin
+    sources are globbed and the JucePlugin_* macros are set by hand, both may
+    need fixing on the first build.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace
+{
+    constexpr int kiInstances = 100;
+    constexpr double kdSampleRate = 48000.0;
+    constexpr int kiBlockSize = 512;
+
+    struct Timing
+    {
+        double dTotalMs = 0.0;
+        double dMaxMs = 0.0;
+
+        template <typename Step>
+        void add (Step&& step)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            step();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            dTotalMs += elapsed.count();
+            dMaxMs = juce::jmax (dMaxMs, elapsed.count());
+        }
+
+        void print (const char* pcStep) const
+        {
+            std::printf ("%-10s  %9.3f ms mean  %9.3f ms max  %9.1f ms total\n", pcStep,
+                         dTotalMs / kiInstances, dMaxMs, dTotalMs);
+        }
+    };
+}
+
+int main()
+{
+    // processors start timers and async updates, which need a message manager
+    juce::ScopedJuceInitialiser_GUI juce;
+
+    std::vector<std::unique_ptr<juce::AudioProcessor>> processors;
+    processors.reserve (kiInstances);
+
+    Timing construct, prepare, destroy;
+    for (int i = 0; i < kiInstances; ++i)
+        construct.add ([&] { processors.emplace_back (createPluginFilter()); });
+
+    for (auto& processor : processors)
+        prepare.add ([&]
+        {
+            processor->setRateAndBufferSizeDetails (kdSampleRate, kiBlockSize);
+            processor->prepareToPlay (kdSampleRate, kiBlockSize);
+        });
+
+    for (auto& processor : processors)
+        destroy.add ([&]
+        {
+            processor->releaseResources();
+            processor.reset();
+        });
+
+    std::printf ("%s, %d instances\n", JucePlugin_Name, kiInstances);
+    construct.print ("construct");
+    prepare.print ("prepare");
+    destroy.print ("destroy");
+    return 0;
+}
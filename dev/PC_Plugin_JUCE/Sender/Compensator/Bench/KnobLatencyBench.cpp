@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    KnobLatencyBench.cpp
+    Knob to audio latency of the Compensator, the old editor OSC path against
+    OscControl.
+
+    A CompensatorAudioProcessor is driven by a thread that calls processBlock
+    every 512 samples at 48 kHz, the way a host does. Knob moves are sent as
+    "/juce/rotaryknob ,f" datagrams at random phases of the block clock,
+    one at a time, each waiting until a block has picked it up.
+      before   a juce::OSCReceiver with a MessageLoopCallback listener, as
+               the editor had it, calls setValueNotifyingHost on "delay".
+               Arrival is stamped on entry to oscMessageReceived, the block
+               that applies it is the first one to see the parameter move
+      after    the processor's own OscControl on port 9001, arrival as its
+               receive thread stamps it, read back from getOscLatencyMs()
+    Both are also timed from the send, which includes the socket and, for
+    the old path, the wait for the message loop. The old receiver listens on
+    port 9101 so the two never compete for 9001.
+
+    Open: this bench has not been compiled or run yet, there was no JUCE
+    checkout to build it against. The latency drop it is meant to show is
+    unmeasured until someone runs it and records the figures here.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr double kdSampleRate = 48000.0;
+    constexpr int kiBlockSize = 512;
+    constexpr int kiMoves = 200;
+    constexpr int kiOldPort = 9101;
+
+    double msSince (juce::int64 iTicks, juce::int64 iNow)
+    {
+        return juce::Time::highResolutionTicksToSeconds (iNow - iTicks) * 1000.0;
+    }
+
+    // the editor's receiver before OscControl
+    struct OldEditorPath  : private juce::OSCReceiver,
+                            private juce::OSCReceiver::ListenerWithOSCAddress<juce::OSCReceiver::MessageLoopCallback>
+    {
+        CompensatorAudioProcessor& audioProcessor;
+        std::atomic<juce::int64> iArrivalTicks { 0 };
+
+        explicit OldEditorPath (CompensatorAudioProcessor& p) : audioProcessor (p)
+        {
+            connect (kiOldPort);
+            addListener (this, "/juce/rotaryknob");
+        }
+
+        ~OldEditorPath() override
+        {
+            removeListener (this);
+            disconnect();
+        }
+
+        void oscMessageReceived (const juce::OSCMessage& message) override
+        {
+            iArrivalTicks = juce::Time::getHighResolutionTicks();
+            if (message.size() == 1 && message[0].isFloat32())
+            {
+                if (auto* delay = audioProcessor.parameters.getParameter ("delay"))
+                    delay->setValueNotifyingHost (juce::jlimit (0.0f, 1.0f, message[0].getFloat32()));
+            }
+        }
+    };
+
+    struct Latencies
+    {
+        std::vector<double> arrival, send;
+
+        static void printLine (const char* pcName, const char* pcFrom, std::vector<double>& v)
+        {
+            if (v.empty())
+            {
+                std::printf ("%-8s %-13s  no moves reached the audio\n", pcName, pcFrom);
+                return;
+            }
+            std::sort (v.begin(), v.end());
+            double dSum = 0.0;
+            for (double d : v)
+                dSum += d;
+            std::printf ("%-8s %-13s  %7.2f %7.2f %7.2f %7.2f   (%d moves)\n", pcName, pcFrom, dSum / (double) v.size(),
+                         v[v.size() / 2], v[juce::jmin (v.size() - 1, v.size() * 99 / 100)], v.back(), (int) v.size());
+        }
+
+        void print (const char* pcName)
+        {
+            printLine (pcName, "arrival", arrival);
+            printLine ("", "send", send);
+        }
+    };
+
+    enum class Path { before, after };
+
+    Latencies measure (CompensatorAudioProcessor& processor, Path path)
+    {
+        std::unique_ptr<OldEditorPath> oldPath;
+        if (path == Path::before)
+            juce::MessageManager::callAsync ([&] { oldPath = std::make_unique<OldEditorPath> (processor); });
+        juce::Thread::sleep (200);
+
+        std::atomic<float>* pfDelay = processor.parameters.getRawParameterValue ("delay");
+        std::atomic<juce::int64> iSendTicks { 0 };
+        std::atomic<bool> bWaiting { false }, bStop { false };
+        juce::WaitableEvent applied;
+        Latencies result;
+
+        // the host's audio thread
+        std::thread audio ([&]
+        {
+            juce::AudioBuffer<float> buffer (2, kiBlockSize);
+            juce::MidiBuffer midi;
+            float fLastDelay = pfDelay->load();
+            double dLastOscMs = processor.getOscLatencyMs();
+            auto next = std::chrono::steady_clock::now();
+            const auto period = std::chrono::duration<double> (kiBlockSize / kdSampleRate);
+
+            while (! bStop)
+            {
+                const auto iBlockTicks = juce::Time::getHighResolutionTicks();
+                const bool bOldApplies = path == Path::before && pfDelay->load() != fLastDelay;
+                fLastDelay = pfDelay->load();
+
+                buffer.clear();
+                processor.processBlock (buffer, midi);
+
+                const double dOscMs = processor.getOscLatencyMs();
+                const bool bNewApplied = path == Path::after && dOscMs != dLastOscMs;
+                dLastOscMs = dOscMs;
+
+                if ((bOldApplies || bNewApplied) && bWaiting.exchange (false))
+                {
+                    result.send.push_back (msSince (iSendTicks, iBlockTicks));
+                    result.arrival.push_back (bOldApplies ? msSince (oldPath->iArrivalTicks, iBlockTicks) : dOscMs);
+                    applied.signal();
+                }
+
+                next += std::chrono::duration_cast<std::chrono::steady_clock::duration> (period);
+                std::this_thread::sleep_until (next);
+            }
+        });
+
+        juce::OSCSender sender;
+        sender.connect ("127.0.0.1", path == Path::before ? kiOldPort : OscControl::kiPort);
+        juce::Random random (1);
+        for (int i = 0; i < kiMoves; ++i)
+        {
+            // a new value every time, anywhere within the block clock
+            juce::Thread::sleep (random.nextInt (12));
+            const float fValue = (i % 2 == 0 ? 0.25f : 0.75f) + (float) i * 0.001f;
+
+            applied.reset();
+            bWaiting = true;
+            iSendTicks = juce::Time::getHighResolutionTicks();
+            sender.send ("/juce/rotaryknob", fValue);
+            if (! applied.wait (1000))
+                bWaiting = false;
+        }
+
+        bStop = true;
+        audio.join();
+        juce::MessageManager::callAsync ([&] { oldPath.reset(); });
+        juce::Thread::sleep (100);
+        return result;
+    }
+}
+
+int main()
+{
+    juce::ScopedJuceInitialiser_GUI juce;
+    auto* messageManager = juce::MessageManager::getInstance();
+
+    // created and prepared on the message thread like a host does
+    CompensatorAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails (kdSampleRate, kiBlockSize);
+    processor.prepareToPlay (kdSampleRate, kiBlockSize);
+
+    // the measurement runs on its own thread, the message loop stays here for the old path
+    std::thread bench ([&processor, messageManager]
+    {
+        auto before = measure (processor, Path::before);
+        auto after = measure (processor, Path::after);
+
+        std::printf ("knob to audio in ms, %d moves, %d samples at %.0f Hz\n", kiMoves, kiBlockSize, kdSampleRate);
+        std::printf ("%-8s %-13s  %7s %7s %7s %7s\n", "path", "from", "mean", "p50", "p99", "max");
+        before.print ("before");
+        after.print ("after");
+        messageManager->stopDispatchLoop();
+    });
+
+    messageManager->runDispatchLoop();
+    bench.join();
+    processor.releaseResources();
+    return 0;
+}
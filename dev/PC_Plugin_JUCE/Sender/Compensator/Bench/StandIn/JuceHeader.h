@@ -0,0 +1,333 @@
+/*
+  ==============================================================================
+
+    JuceHeader.h (stand-in)
+    Just enough of JUCE to compile the DSP classes of the plugins with a plain
+    compiler, for quick checks where no JUCE checkout is at hand.
+
+    It covers the Compensator's DelayLine, DelayLineResizer, FirKernel,
+    ChannelAligner, DelayEstimator, LatencyMeter, LatencyTracker,
+    OscScheduler and OscParser.h, the Sender's LevelKernel, and the
+    receiver's JitterBuffer, PolyphaseResampler and StreamPlayer. Put this
+    folder on the include path and compile them with a small driver of your
+    own, from Compensator/Bench for example:
+      g++ -std=c++17 -O2 -IStandIn -I../Source driver.cpp ../Source/DelayLine.cpp ../Source/FirKernel.cpp
+
+    The classes only behave like JUCE's as far as those sources rely on them.
+    Thread, CriticalSection and Time are inert, nothing here starts a thread
+    or locks, so anything it checks is single threaded. dsp::FFT is a plain
+    radix-2 transform in the packed layout of JUCE's real-only transforms.
+    Plugins, editors, sockets and OSC still need the real thing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#define jassert(expression) assert (expression)
+#define jassertfalse assert (false)
+#define JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(className)
+
+#ifndef forcedinline
+ #define forcedinline inline __attribute__ ((always_inline))
+#endif
+
+#if defined (__x86_64__) || defined (__i386__)
+ #define JUCE_INTEL 1
+#endif
+#if defined (__clang__)
+ #define JUCE_CLANG 1
+#elif defined (__GNUC__)
+ #define JUCE_GCC 1
+#endif
+
+namespace juce
+{
+    using int16 = int16_t;
+    using int32 = int32_t;
+    using int64 = int64_t;
+    using uint8 = uint8_t;
+    using uint16 = uint16_t;
+    using uint32 = uint32_t;
+    using uint64 = uint64_t;
+
+    template <typename... Types> void ignoreUnused (Types&&...) noexcept {}
+
+    //==============================================================================
+    template <typename Type> Type jlimit (Type lowerLimit, Type upperLimit, Type value)
+    {
+        return value < lowerLimit ? lowerLimit : (value > upperLimit ? upperLimit : value);
+    }
+
+    template <typename Type> Type jmin (Type a, Type b)             { return a < b ? a : b; }
+    template <typename Type> Type jmin (Type a, Type b, Type c)     { return jmin (jmin (a, b), c); }
+    template <typename Type> Type jmax (Type a, Type b)             { return a > b ? a : b; }
+    template <typename Type> Type jmax (Type a, Type b, Type c)     { return jmax (jmax (a, b), c); }
+
+    inline int roundToInt (double value)    { return (int) std::lround (value); }
+
+    inline int nextPowerOfTwo (int n)
+    {
+        int iPower = 1;
+        while (iPower < n)
+            iPower <<= 1;
+        return iPower;
+    }
+
+    template <typename FloatType>
+    struct MathConstants
+    {
+        static constexpr FloatType pi = static_cast<FloatType> (3.141592653589793238L);
+        static constexpr FloatType twoPi = 2 * pi;
+    };
+
+    //==============================================================================
+    template <typename Type>
+    struct HeapBlock
+    {
+        HeapBlock() = default;
+        explicit HeapBlock (size_t numElements) : data (numElements) {}
+
+        void allocate (size_t numElements, bool /*initialiseToZero*/)  { data.assign (numElements, Type()); }
+        void realloc (size_t numElements)                               { data.resize (numElements); }
+        void swapWith (HeapBlock& other)                                { data.swap (other.data); }
+
+        Type* getData()                         { return data.data(); }
+        const Type* getData() const             { return data.data(); }
+        Type& operator[] (size_t index)         { return data[index]; }
+        operator Type*()                        { return data.data(); }
+        operator Type*() const                  { return const_cast<Type*> (data.data()); }
+
+    private:
+        std::vector<Type> data;
+    };
+
+    //==============================================================================
+    template <typename Type>
+    struct AudioBuffer
+    {
+        AudioBuffer() = default;
+        AudioBuffer (int numChannels, int numSamples)   { setSize (numChannels, numSamples); }
+
+        void setSize (int numChannels, int numSamples, bool = false, bool = false, bool = false)
+        {
+            channels.assign ((size_t) numChannels, std::vector<Type> ((size_t) numSamples));
+            size = numSamples;
+        }
+
+        void clear()
+        {
+            for (auto& channel : channels)
+                std::fill (channel.begin(), channel.end(), Type());
+        }
+
+        int getNumChannels() const                                  { return (int) channels.size(); }
+        int getNumSamples() const                                   { return size; }
+        Type* getWritePointer (int channel, int offset = 0)         { return channels[(size_t) channel].data() + offset; }
+        const Type* getReadPointer (int channel, int offset = 0) const { return channels[(size_t) channel].data() + offset; }
+        void setSample (int channel, int index, Type value)         { channels[(size_t) channel][(size_t) index] = value; }
+
+        Type* const* getArrayOfWritePointers()
+        {
+            pointers.clear();
+            for (auto& channel : channels)
+                pointers.push_back (channel.data());
+            return pointers.data();
+        }
+
+    private:
+        std::vector<std::vector<Type>> channels;
+        std::vector<Type*> pointers;
+        int size = 0;
+    };
+
+    //==============================================================================
+    struct FloatVectorOperations
+    {
+        static void copy (float* pfDest, const float* pfSrc, int iNum)  { if (iNum > 0) std::memcpy (pfDest, pfSrc, (size_t) iNum * sizeof (float)); }
+        static void clear (float* pfDest, int iNum)                     { if (iNum > 0) std::memset (pfDest, 0, (size_t) iNum * sizeof (float)); }
+        static void fill (float* pfDest, float fValue, int iNum)        { for (int i = 0; i < iNum; ++i) pfDest[i] = fValue; }
+        static void add (float* pfDest, const float* pfSrc, int iNum)   { for (int i = 0; i < iNum; ++i) pfDest[i] += pfSrc[i]; }
+    };
+
+    //==============================================================================
+    // one slot is kept free like JUCE's, and the second block always starts at 0
+    struct AbstractFifo
+    {
+        explicit AbstractFifo (int capacity) : bufferSize (capacity) {}
+
+        void reset()                    { readPos = 0; writePos = 0; }
+        int getNumReady() const         { const int iReady = writePos - readPos; return iReady < 0 ? iReady + bufferSize : iReady; }
+        int getFreeSpace() const        { return bufferSize - 1 - getNumReady(); }
+
+        void prepareToWrite (int iNum, int& start1, int& size1, int& start2, int& size2) const
+        {
+            iNum = std::min (iNum, getFreeSpace());
+            start1 = writePos;
+            size1 = std::min (iNum, bufferSize - writePos);
+            start2 = 0;
+            size2 = iNum - size1;
+        }
+
+        void prepareToRead (int iNum, int& start1, int& size1, int& start2, int& size2) const
+        {
+            iNum = std::min (iNum, getNumReady());
+            start1 = readPos;
+            size1 = std::min (iNum, bufferSize - readPos);
+            start2 = 0;
+            size2 = iNum - size1;
+        }
+
+        void finishedWrite (int iNum)   { writePos = (writePos + iNum) % bufferSize; }
+        void finishedRead (int iNum)    { readPos = (readPos + iNum) % bufferSize; }
+
+    private:
+        int bufferSize;
+        std::atomic<int> readPos { 0 }, writePos { 0 };
+    };
+
+    //==============================================================================
+    struct Random
+    {
+        explicit Random (int64 seed) : state ((uint64) seed * 6364136223846793005ull + 1) {}
+
+        float nextFloat()
+        {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            return (float) ((state >> 40) & 0xffffff) / 16777216.0f;
+        }
+
+    private:
+        uint64 state;
+    };
+
+    //==============================================================================
+    struct ByteOrder
+    {
+        static uint32 swapIfLittleEndian (uint32 v)     { return __builtin_bswap32 (v); }
+        static uint64 swapIfLittleEndian (uint64 v)     { return __builtin_bswap64 (v); }
+    };
+
+    struct SystemStats
+    {
+       #if JUCE_INTEL
+        static bool hasAVX2()   { return __builtin_cpu_supports ("avx2"); }
+        static bool hasFMA3()   { return __builtin_cpu_supports ("fma"); }
+       #else
+        static bool hasAVX2()   { return false; }
+        static bool hasFMA3()   { return false; }
+       #endif
+    };
+
+    //==============================================================================
+    // inert, the sources only need them to compile
+    struct Thread
+    {
+        enum class Priority { low, normal, high };
+
+        explicit Thread (const char*) {}
+        virtual ~Thread() = default;
+        virtual void run() = 0;
+
+        void startThread (Priority = Priority::normal) {}
+        void stopThread (int) {}
+        bool threadShouldExit() const   { return false; }
+        bool isThreadRunning() const    { return false; }
+        void wait (int) {}
+        void notify() {}
+    };
+
+    struct CriticalSection {};
+    struct ScopedLock { explicit ScopedLock (const CriticalSection&) {} };
+
+    struct Time
+    {
+        static uint32 getMillisecondCounter()   { return 0; }
+    };
+
+    //==============================================================================
+    namespace dsp
+    {
+        struct FFT
+        {
+            explicit FFT (int order) : fftSize (1 << order) {}
+            int getSize() const     { return fftSize; }
+
+            // fftSize + 2 floats out: re and im of bins 0 to fftSize / 2
+            void performRealOnlyForwardTransform (float* pfData, bool = false) const
+            {
+                std::vector<std::complex<double>> bins ((size_t) fftSize);
+                for (int i = 0; i < fftSize; ++i)
+                    bins[(size_t) i] = pfData[i];
+                transform (bins, false);
+                for (int k = 0; k <= fftSize / 2; ++k)
+                {
+                    pfData[2 * k] = (float) bins[(size_t) k].real();
+                    pfData[2 * k + 1] = (float) bins[(size_t) k].imag();
+                }
+            }
+
+            void performRealOnlyInverseTransform (float* pfData) const
+            {
+                std::vector<std::complex<double>> bins ((size_t) fftSize);
+                for (int k = 0; k <= fftSize / 2; ++k)
+                {
+                    bins[(size_t) k] = { pfData[2 * k], pfData[2 * k + 1] };
+                    if (k > 0 && k < fftSize / 2)
+                        bins[(size_t) (fftSize - k)] = std::conj (bins[(size_t) k]);
+                }
+                transform (bins, true);
+                for (int i = 0; i < fftSize; ++i)
+                    pfData[i] = (float) (bins[(size_t) i].real() / fftSize);
+            }
+
+        private:
+            static void transform (std::vector<std::complex<double>>& bins, bool bInverse)
+            {
+                const int n = (int) bins.size();
+                for (int i = 1, j = 0; i < n; ++i)
+                {
+                    int bit = n >> 1;
+                    for (; j & bit; bit >>= 1)
+                        j ^= bit;
+                    j ^= bit;
+                    if (i < j)
+                        std::swap (bins[(size_t) i], bins[(size_t) j]);
+                }
+
+                for (int len = 2; len <= n; len <<= 1)
+                {
+                    const double dAngle = 2.0 * MathConstants<double>::pi / len * (bInverse ? 1.0 : -1.0);
+                    const std::complex<double> step (std::cos (dAngle), std::sin (dAngle));
+                    for (int i = 0; i < n; i += len)
+                    {
+                        std::complex<double> w (1.0);
+                        for (int j = 0; j < len / 2; ++j)
+                        {
+                            const auto u = bins[(size_t) (i + j)];
+                            const auto v = bins[(size_t) (i + j + len / 2)] * w;
+                            bins[(size_t) (i + j)] = u + v;
+                            bins[(size_t) (i + j + len / 2)] = u - v;
+                            w *= step;
+                        }
+                    }
+                }
+            }
+
+            int fftSize;
+        };
+    }
+}
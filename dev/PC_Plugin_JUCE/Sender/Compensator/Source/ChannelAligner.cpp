@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    ChannelAligner.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelAligner.h"
+
+ChannelAligner::ChannelAligner()
+    : juce::Thread ("ChannelAligner")
+{
+}
+
+ChannelAligner::~ChannelAligner()
+{
+    stopThread (2000);
+}
+
+void ChannelAligner::prepare (double sampleRate, int iNumChannels)
+{
+    // an analysis still running would read the buffers reallocated here
+    stopThread (2000);
+
+    m_state = State::idle;
+    m_bStartRequested = false;
+    m_iNumChannels = juce::jmin (iNumChannels, kiMaxChannels);
+    m_iWindow = (int) (kfWindowSec * sampleRate);
+    m_iMaxSkew = (int) (kfMaxSkewSec * sampleRate);
+
+    // channel 1 is compared from m_iMaxSkew on, so every channel is recorded
+    // that much longer on both sides of the window
+    m_fCapture.setSize (m_iNumChannels, m_iWindow + 2 * m_iMaxSkew);
+    m_estimator.prepare (m_iWindow, 2 * m_iMaxSkew);
+
+    {
+        const juce::ScopedLock sl (m_resultLock);
+        for (auto& result : m_results)
+            result = {};
+    }
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void ChannelAligner::start()
+{
+    if (m_iNumChannels > 1 && m_state != State::capturing && m_state != State::analysing)
+        m_bStartRequested = true;
+}
+
+void ChannelAligner::process (const float* const* ppfInput, int iNumChannels, int iNumSamples)
+{
+    if (m_bStartRequested.exchange (false))
+    {
+        m_iPosition = 0;
+        m_state = State::capturing;
+    }
+
+    if (m_state != State::capturing)
+        return;
+
+    const int iNum = juce::jmin (iNumSamples, m_fCapture.getNumSamples() - m_iPosition);
+    for (int ch = 0; ch < juce::jmin (iNumChannels, m_iNumChannels); ++ch)
+        juce::FloatVectorOperations::copy (m_fCapture.getWritePointer (ch, m_iPosition), ppfInput[ch], iNum);
+
+    m_iPosition += iNum;
+    if (m_iPosition >= m_fCapture.getNumSamples())
+        m_state = State::analysing;
+}
+
+DelayEstimator::Result ChannelAligner::getResult (int iChannel) const
+{
+    const juce::ScopedLock sl (m_resultLock);
+    return m_results[iChannel];
+}
+
+void ChannelAligner::run()
+{
+    // polled, so the audio thread never has to signal anything
+    while (! threadShouldExit())
+    {
+        if (m_state == State::analysing)
+        {
+            DelayEstimator::Result results[kiMaxChannels];
+            results[0].fConfidence = 1.0f;
+
+            // the lag found over 0 .. 2 * skew is measured from channel 1's window start
+            const float* pfReference = m_fCapture.getReadPointer (0, m_iMaxSkew);
+            for (int ch = 1; ch < m_iNumChannels && ! threadShouldExit(); ++ch)
+            {
+                results[ch] = m_estimator.estimate (pfReference, m_iWindow,
+                                                    m_fCapture.getReadPointer (ch), m_fCapture.getNumSamples());
+                results[ch].dLag -= m_iMaxSkew;
+            }
+
+            {
+                const juce::ScopedLock sl (m_resultLock);
+                std::copy (std::begin (results), std::end (results), std::begin (m_results));
+            }
+
+            m_state = State::done;
+            if (onFinished != nullptr)
+                onFinished();
+        }
+
+        wait (50);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    ChannelAligner.h
+    Finds how far each input channel is skewed against the first one.
+
+    Returned stems and microphones reach the Compensator over paths of their
+    own. On request the audio thread records a short stretch of every input
+    channel before it is delayed, and the aligner's thread correlates each
+    channel against channel 1 with the same GCC-PHAT estimator the latency
+    measurement uses. Channels may lead or lag the reference by up to
+    kfMaxSkewSec.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayEstimator.h"
+
+class ChannelAligner  : private juce::Thread
+{
+public:
+    enum class State { idle, capturing, analysing, done };
+
+    static constexpr int kiMaxChannels = 32;
+
+    // length of channel 1 correlated against the others
+    static constexpr double kfWindowSec = 0.5;
+
+    // how far a channel may lead or lag channel 1
+    static constexpr double kfMaxSkewSec = 0.25;
+
+    // channels below this keep their delay
+    static constexpr float kfMinConfidence = 0.4f;
+
+    ChannelAligner();
+    ~ChannelAligner() override;
+
+    // allocates the capture buffer, call from prepareToPlay
+    void prepare (double sampleRate, int iNumChannels);
+
+    // any thread, capturing starts with the next audio block
+    void start();
+
+    // audio thread: records the input while capturing
+    void process (const float* const* ppfInput, int iNumChannels, int iNumSamples);
+
+    State getState() const { return m_state; }
+    int getNumChannels() const { return m_iNumChannels; }
+
+    // samples channel iChannel lags channel 1 by, negative when it leads
+    DelayEstimator::Result getResult (int iChannel) const;
+
+    // called on the aligner thread when the state turned to done
+    std::function<void()> onFinished;
+
+private:
+    void run() override;
+
+    std::atomic<State> m_state { State::idle };
+    std::atomic<bool> m_bStartRequested { false };
+
+    juce::AudioBuffer<float> m_fCapture;
+    int m_iNumChannels = 0;
+    int m_iWindow = 0;
+    int m_iMaxSkew = 0;
+    int m_iPosition = 0;
+
+    DelayEstimator m_estimator;
+    juce::CriticalSection m_resultLock;
+    DelayEstimator::Result m_results[kiMaxChannels];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChannelAligner)
+};
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    DelayEstimator.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayEstimator.h"
+
+void DelayEstimator::prepare (int iMaxReference, int iMaxLag)
+{
+    // long enough that lags up to iMaxLag do not wrap around
+    const int iOrder = juce::roundToInt (std::ceil (std::log2 ((double) (iMaxReference + iMaxReference + iMaxLag))));
+    if (m_fft == nullptr || m_fft->getSize() != (1 << iOrder))
+    {
+        m_fft = std::make_unique<juce::dsp::FFT> (iOrder);
+        m_iFftSize = m_fft->getSize();
+        m_fRefSpectrum.allocate ((size_t) m_iFftSize * 2, true);
+        m_fCapSpectrum.allocate ((size_t) m_iFftSize * 2, true);
+    }
+    m_iMaxLag = iMaxLag;
+}
+
+DelayEstimator::Result DelayEstimator::estimate (const float* pfReference, int iRefLen, const float* pfCaptured, int iCapLen)
+{
+    jassert (m_fft != nullptr && iRefLen + iCapLen <= m_iFftSize);
+
+    juce::FloatVectorOperations::clear (m_fRefSpectrum, m_iFftSize * 2);
+    juce::FloatVectorOperations::clear (m_fCapSpectrum, m_iFftSize * 2);
+    juce::FloatVectorOperations::copy (m_fRefSpectrum, pfReference, iRefLen);
+    juce::FloatVectorOperations::copy (m_fCapSpectrum, pfCaptured, iCapLen);
+
+    m_fft->performRealOnlyForwardTransform (m_fRefSpectrum, true);
+    m_fft->performRealOnlyForwardTransform (m_fCapSpectrum, true);
+
+    // cross spectrum captured * conj (reference), whitened
+    auto* pRef = reinterpret_cast<std::complex<float>*> (m_fRefSpectrum.getData());
+    auto* pCap = reinterpret_cast<std::complex<float>*> (m_fCapSpectrum.getData());
+    for (int k = 0; k <= m_iFftSize / 2; ++k)
+    {
+        const std::complex<float> cross = pCap[k] * std::conj (pRef[k]);
+        const float fMagnitude = std::abs (cross);
+        pCap[k] = fMagnitude > 1.0e-20f ? cross / std::pow (fMagnitude, kfPhatBeta) : std::complex<float>();
+    }
+
+    m_fft->performRealOnlyInverseTransform (m_fCapSpectrum);
+    return findPeak (m_fCapSpectrum, juce::jmin (m_iMaxLag, iCapLen - 1) + 1);
+}
+
+DelayEstimator::Result DelayEstimator::findPeak (const float* pfCorrelation, int iNumLags)
+{
+    Result result;
+
+    // polarity may be flipped somewhere on the way, so look at the magnitude
+    const int iMaxLag = iNumLags - 1;
+    int iPeak = 0;
+    float fPeak = 0.0f;
+    for (int k = 0; k <= iMaxLag; ++k)
+    {
+        if (std::abs (pfCorrelation[k]) > fPeak)
+        {
+            fPeak = std::abs (pfCorrelation[k]);
+            iPeak = k;
+        }
+    }
+
+    if (fPeak <= 0.0f)
+        return result;
+
+    float fRunnerUp = 0.0f;
+    for (int k = 0; k <= iMaxLag; ++k)
+        if (std::abs (k - iPeak) > kiPeakGuard)
+            fRunnerUp = juce::jmax (fRunnerUp, std::abs (pfCorrelation[k]));
+
+    // the correlation is band limited, so evaluate it between the samples with
+    // a windowed sinc and search the maximum there instead of fitting a parabola
+    const float fSign = pfCorrelation[iPeak] < 0.0f ? -1.0f : 1.0f;
+    auto valueAt = [&] (double dOffset)
+    {
+        double dSum = 0.0;
+        for (int k = -kiRefineTaps; k <= kiRefineTaps; ++k)
+        {
+            const int iIndex = iPeak + k;
+            if (iIndex < 0 || iIndex > iMaxLag)
+                continue;
+
+            const double dX = dOffset - k;
+            const double dSinc = std::abs (dX) < 1.0e-9 ? 1.0 : std::sin (juce::MathConstants<double>::pi * dX) / (juce::MathConstants<double>::pi * dX);
+            const double dWindow = 0.5 + 0.5 * std::cos (juce::MathConstants<double>::pi * dX / (kiRefineTaps + 1));
+            dSum += pfCorrelation[iIndex] * dSinc * dWindow;
+        }
+        return dSum * fSign;
+    };
+
+    double dLow = -0.5, dHigh = 0.5;
+    for (int i = 0; i < 40; ++i)
+    {
+        const double dA = dLow + (dHigh - dLow) / 3.0;
+        const double dB = dHigh - (dHigh - dLow) / 3.0;
+        if (valueAt (dA) < valueAt (dB))
+            dLow = dA;
+        else
+            dHigh = dB;
+    }
+    const double dOffset = 0.5 * (dLow + dHigh);
+
+    result.dLag = iPeak + dOffset;
+    result.fConfidence = 1.0f - fRunnerUp / fPeak;
+    return result;
+}
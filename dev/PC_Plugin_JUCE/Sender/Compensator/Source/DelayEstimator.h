@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    DelayEstimator.h
+    Finds how far a captured signal lags a reference one.
+
+    Cross-correlation is computed in the frequency domain with a PHAT style
+    weighting: the cross spectrum is whitened (partially, see kfPhatBeta) so the
+    peak stays sharp whatever EQ, codec or effects the signal went through on
+    the way. The peak is placed between samples on a windowed-sinc
+    reconstruction of the correlation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class DelayEstimator
+{
+public:
+    struct Result
+    {
+        double dLag = 0.0;          // in samples, captured[n + dLag] ~ reference[n]
+        float fConfidence = 0.0f;   // 0 = no clear peak, 1 = a single unambiguous peak
+    };
+
+    DelayEstimator() = default;
+
+    // allocates, sized for a reference of iMaxReference samples searched over lags 0 .. iMaxLag
+    void prepare (int iMaxReference, int iMaxLag);
+
+    // pfCaptured holds iRefLen + iMaxLag samples recorded from the moment the reference started
+    Result estimate (const float* pfReference, int iRefLen, const float* pfCaptured, int iCapLen);
+
+    // strongest lag of a correlation over lags 0 .. iNumLags - 1, with its confidence
+    static Result findPeak (const float* pfCorrelation, int iNumLags);
+
+    // 1 is plain PHAT, lower keeps some of the magnitude so bands a codec removed add less noise
+    static constexpr float kfPhatBeta = 0.8f;
+
+private:
+
+    // samples around the main peak ignored when looking for the runner up
+    static constexpr int kiPeakGuard = 16;
+
+    // half length of the sinc used to place the peak between samples
+    static constexpr int kiRefineTaps = 8;
+
+    std::unique_ptr<juce::dsp::FFT> m_fft;
+    juce::HeapBlock<float> m_fRefSpectrum, m_fCapSpectrum;
+    int m_iFftSize = 0;
+    int m_iMaxLag = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayEstimator)
+};
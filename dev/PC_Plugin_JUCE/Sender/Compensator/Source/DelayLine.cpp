@@ -0,0 +1,258 @@
+/*
+  ==============================================================================
+
+    DelayLine.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayLine.h"
+
+namespace
+{
+    constexpr float kfInt16Scale = 32767.0f;
+    constexpr float kfInt24Scale = 8388607.0f;
+
+    int bytesPerSample (DelayLine::Format format)
+    {
+        switch (format)
+        {
+            case DelayLine::Format::int24: return 3;
+            case DelayLine::Format::int16: return 2;
+            default:                       return (int) sizeof (float);
+        }
+    }
+
+    // plain loops with no branches inside, the compiler turns them into SIMD code
+    void packInt16 (juce::int16* piDest, const float* pfSrc, int iNum)
+    {
+        for (int i = 0; i < iNum; ++i)
+            piDest[i] = (juce::int16) juce::roundToInt (juce::jlimit (-1.0f, 1.0f, pfSrc[i]) * kfInt16Scale);
+    }
+
+    void unpackInt16 (float* pfDest, const juce::int16* piSrc, int iNum)
+    {
+        for (int i = 0; i < iNum; ++i)
+            pfDest[i] = (float) piSrc[i] * (1.0f / kfInt16Scale);
+    }
+
+    // little endian, three bytes per sample
+    void packInt24 (juce::uint8* pDest, const float* pfSrc, int iNum)
+    {
+        for (int i = 0; i < iNum; ++i)
+        {
+            const int iValue = juce::roundToInt (juce::jlimit (-1.0f, 1.0f, pfSrc[i]) * kfInt24Scale);
+            pDest[3 * i]     = (juce::uint8) iValue;
+            pDest[3 * i + 1] = (juce::uint8) (iValue >> 8);
+            pDest[3 * i + 2] = (juce::uint8) (iValue >> 16);
+        }
+    }
+
+    inline float unpackInt24 (const juce::uint8* pSrc)
+    {
+        // into the top of an int32, the arithmetic shift brings the sign along
+        const int iValue = (int) ((juce::uint32) pSrc[0] << 8 | (juce::uint32) pSrc[1] << 16 | (juce::uint32) pSrc[2] << 24) >> 8;
+        return (float) iValue * (1.0f / kfInt24Scale);
+    }
+
+    void unpackInt24 (float* pfDest, const juce::uint8* pSrc, int iNum)
+    {
+        for (int i = 0; i < iNum; ++i)
+            pfDest[i] = unpackInt24 (pSrc + 3 * i);
+    }
+}
+
+int DelayLine::lengthFor (int iMaxDelay, int iMaxBlockSize)
+{
+    return juce::nextPowerOfTwo (iMaxDelay + iMaxBlockSize + kiInterpolationTaps);
+}
+
+void DelayLine::prepare (int iNumChannels, int iMaxDelay, int iMaxBlockSize, Format format)
+{
+    m_format = format;
+    m_iBytesPerSample = bytesPerSample (format);
+    m_iNumChannels = iNumChannels;
+    m_iMaxBlockSize = iMaxBlockSize;
+    m_iLength = lengthFor (iMaxDelay, iMaxBlockSize);
+    m_iMask = m_iLength - 1;
+    m_data.allocate ((size_t) iNumChannels * (size_t) m_iLength * (size_t) m_iBytesPerSample, false);
+    m_fScratch.allocate ((size_t) (iMaxBlockSize + kiInterpolationTaps), true);
+    m_fir = FirKernel::select (iMaxBlockSize);
+    clear();
+}
+
+void DelayLine::clear()
+{
+    // zero is silence in every format
+    std::memset (m_data, 0, getMemoryFootprint());
+    continueFrom (0);
+}
+
+void DelayLine::continueFrom (juce::int64 iNumWritten)
+{
+    m_iWriteIdx = (int) (iNumWritten & m_iMask);
+    m_iWritten.store (iNumWritten, std::memory_order_release);
+}
+
+bool DelayLine::needsRealloc (int iNumChannels, int iMaxDelay, int iMaxBlockSize, Format format) const
+{
+    return iNumChannels != getNumChannels()
+        || iMaxBlockSize != m_iMaxBlockSize
+        || format != m_format
+        || lengthFor (iMaxDelay, iMaxBlockSize) != m_iLength;
+}
+
+void DelayLine::load (int iChannel, int iIdx, float* pfDest, int iNumSamples) const
+{
+    const char* pRing = getChannel (iChannel);
+    const int iFirst = juce::jmin (iNumSamples, m_iLength - iIdx);
+
+    for (int iSegment = 0; iSegment < 2; ++iSegment)
+    {
+        const int iNum = iSegment == 0 ? iFirst : iNumSamples - iFirst;
+        const char* pSrc = pRing + (size_t) (iSegment == 0 ? iIdx : 0) * (size_t) m_iBytesPerSample;
+        float* pfOut = pfDest + (iSegment == 0 ? 0 : iFirst);
+
+        switch (m_format)
+        {
+            case Format::float32: std::memcpy (pfOut, pSrc, (size_t) iNum * sizeof (float)); break;
+            case Format::int24:   unpackInt24 (pfOut, reinterpret_cast<const juce::uint8*> (pSrc), iNum); break;
+            case Format::int16:   unpackInt16 (pfOut, reinterpret_cast<const juce::int16*> (pSrc), iNum); break;
+        }
+    }
+}
+
+void DelayLine::store (int iChannel, int iIdx, const float* pfSrc, int iNumSamples)
+{
+    char* pRing = getChannel (iChannel);
+    const int iFirst = juce::jmin (iNumSamples, m_iLength - iIdx);
+
+    for (int iSegment = 0; iSegment < 2; ++iSegment)
+    {
+        const int iNum = iSegment == 0 ? iFirst : iNumSamples - iFirst;
+        char* pDest = pRing + (size_t) (iSegment == 0 ? iIdx : 0) * (size_t) m_iBytesPerSample;
+        const float* pfIn = pfSrc + (iSegment == 0 ? 0 : iFirst);
+
+        switch (m_format)
+        {
+            case Format::float32: std::memcpy (pDest, pfIn, (size_t) iNum * sizeof (float)); break;
+            case Format::int24:   packInt24 (reinterpret_cast<juce::uint8*> (pDest), pfIn, iNum); break;
+            case Format::int16:   packInt16 (reinterpret_cast<juce::int16*> (pDest), pfIn, iNum); break;
+        }
+    }
+}
+
+void DelayLine::copyHistoryFrom (const DelayLine& other, juce::int64 iFrom, juce::int64 iTo)
+{
+    iFrom = juce::jmax (iFrom, iTo - m_iLength, iTo - other.m_iLength);
+    const int iChannels = juce::jmin (getNumChannels(), other.getNumChannels());
+    const int iChunk = m_iMaxBlockSize + kiInterpolationTaps;
+
+    // through the scratch a chunk at a time, converting between the formats.
+    // Oldest first, ahead of the writes that overwrite the other ring
+    for (int ch = 0; ch < iChannels; ++ch)
+    {
+        for (juce::int64 i = iFrom; i < iTo; i += iChunk)
+        {
+            const int iNum = (int) juce::jmin ((juce::int64) iChunk, iTo - i);
+            other.load (ch, (int) (i & other.m_iMask), m_fScratch, iNum);
+            store (ch, (int) (i & m_iMask), m_fScratch, iNum);
+        }
+    }
+}
+
+void DelayLine::write (int iChannel, const float* pfSrc, int iNumSamples)
+{
+    jassert (iNumSamples <= m_iMaxBlockSize);
+    store (iChannel, m_iWriteIdx, pfSrc, iNumSamples);
+}
+
+void DelayLine::read (int iChannel, float* pfDest, int iNumSamples, int iDelay) const
+{
+    jassert (iDelay >= 0 && iDelay <= getMaxDelay());
+    load (iChannel, (m_iWriteIdx - iDelay) & m_iMask, pfDest, iNumSamples);
+}
+
+int DelayLine::splitDelay (float fDelay, float& fFrac)
+{
+    // keep the fractional position between the two middle taps where Lagrange
+    // is most accurate, except below one sample where no newer tap exists
+    const int iFirstTap = juce::jmax (0, (int) fDelay - 1);
+    fFrac = fDelay - (float) iFirstTap;
+    return iFirstTap;
+}
+
+void DelayLine::readFractional (int iChannel, float* pfDest, int iNumSamples, float fDelay)
+{
+    float fD;
+    const int iFirstTap = splitDelay (fDelay, fD);
+    if (fD == 1.0f || (iFirstTap == 0 && fD == 0.0f))
+    {
+        read (iChannel, pfDest, iNumSamples, (int) fDelay);
+        return;
+    }
+
+    // tap n reads iFirstTap + n samples back, h[n] its Lagrange weight for delay fD
+    const float h[kiInterpolationTaps] = {
+        -(fD - 1.0f) * (fD - 2.0f) * (fD - 3.0f) / 6.0f,
+        fD * (fD - 2.0f) * (fD - 3.0f) / 2.0f,
+        -fD * (fD - 1.0f) * (fD - 3.0f) / 2.0f,
+        fD * (fD - 1.0f) * (fD - 2.0f) / 6.0f
+    };
+
+    // the oldest tap first, then one contiguous FIR
+    const int iSpan = iNumSamples + kiInterpolationTaps - 1;
+    load (iChannel, (m_iWriteIdx - iFirstTap - (kiInterpolationTaps - 1)) & m_iMask, m_fScratch, iSpan);
+    m_fir (pfDest, m_fScratch, h, iNumSamples);
+}
+
+template <typename Sample>
+void DelayLine::readFarrow (const Sample& sample, float* pfDest, int iNumSamples, const float* pfDelay) const
+{
+    for (int i = 0; i < iNumSamples; ++i)
+    {
+        float fD;
+        const int iFirstTap = splitDelay (pfDelay[i], fD);
+        const int iIdx = m_iWriteIdx + i - iFirstTap;
+        const float x0 = sample (iIdx & m_iMask);
+        const float x1 = sample ((iIdx - 1) & m_iMask);
+        const float x2 = sample ((iIdx - 2) & m_iMask);
+        const float x3 = sample ((iIdx - 3) & m_iMask);
+
+        // Farrow form: the polynomial through the four taps, evaluated at fD
+        const float d1 = x1 - x0;
+        const float d2 = x2 - 2.0f * x1 + x0;
+        const float d3 = x3 - 3.0f * x2 + 3.0f * x1 - x0;
+        const float c3 = d3 * (1.0f / 6.0f);
+        const float c2 = 0.5f * (d2 - d3);
+        const float c1 = d1 - 0.5f * d2 + d3 * (1.0f / 3.0f);
+        pfDest[i] = ((c3 * fD + c2) * fD + c1) * fD + x0;
+    }
+}
+
+void DelayLine::readInterpolated (int iChannel, float* pfDest, int iNumSamples, const float* pfDelay) const
+{
+    // the taps of a glide are scattered, so compact samples are unpacked one by one
+    const char* pRing = getChannel (iChannel);
+    switch (m_format)
+    {
+        case Format::float32:
+        {
+            const float* pfRing = reinterpret_cast<const float*> (pRing);
+            readFarrow ([pfRing] (int i) { return pfRing[i]; }, pfDest, iNumSamples, pfDelay);
+            break;
+        }
+        case Format::int24:
+        {
+            const juce::uint8* pRing24 = reinterpret_cast<const juce::uint8*> (pRing);
+            readFarrow ([pRing24] (int i) { return unpackInt24 (pRing24 + 3 * i); }, pfDest, iNumSamples, pfDelay);
+            break;
+        }
+        case Format::int16:
+        {
+            const juce::int16* piRing = reinterpret_cast<const juce::int16*> (pRing);
+            readFarrow ([piRing] (int i) { return (float) piRing[i] * (1.0f / kfInt16Scale); }, pfDest, iNumSamples, pfDelay);
+            break;
+        }
+    }
+}
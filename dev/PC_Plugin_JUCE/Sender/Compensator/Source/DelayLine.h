@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    DelayLine.h
+    Multichannel ring buffer for the Compensator.
+
+    The length is a power of two so indices wrap with a mask. Writes and fixed
+    delay reads touch at most two contiguous segments per channel and block
+    and are done with memcpy. A fixed fractional delay adds a 4 tap FIR with
+    third order Lagrange coefficients over that copy (see FirKernel.h), and only a gliding delay
+    evaluates the Lagrange polynomial per sample, in Farrow form.
+
+    Long delays can be kept as 24 or 16 bit integers instead of floats, which
+    cuts the ring to three quarters or half. Samples are packed on the way in
+    and unpacked into the same scratch copy on the way out, so the
+    interpolation always runs on floats.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FirKernel.h"
+
+class DelayLine
+{
+public:
+    // how the ring stores samples, in the order of the "storage" parameter
+    enum class Format { float32, int24, int16 };
+
+    DelayLine() = default;
+
+    // allocates, call from prepareToPlay only. A block being written must not
+    // overwrite what the same block reads, so the ring holds iMaxDelay plus a block
+    void prepare (int iNumChannels, int iMaxDelay, int iMaxBlockSize, Format format = Format::float32);
+    void clear();
+
+    // whether prepare() with these arguments would allocate a different ring
+    bool needsRealloc (int iNumChannels, int iMaxDelay, int iMaxBlockSize, Format format) const;
+
+    // Samples written since prepare() or clear(). A line that replaces another
+    // continues its count, so the same number names the same sample in both.
+    // Safe to read from another thread than the one writing
+    juce::int64 getNumWritten() const { return m_iWritten.load (std::memory_order_acquire); }
+    void continueFrom (juce::int64 iNumWritten);
+
+    // copies the samples numbered iFrom up to iTo from another line, of any
+    // format, so the output continues seamlessly. May run on another thread
+    // while the audio thread writes to the other line: samples it overwrites
+    // meanwhile are past what the other line could still read anyway
+    void copyHistoryFrom (const DelayLine& other, juce::int64 iFrom, juce::int64 iTo);
+
+    int getLength() const { return m_iLength; }
+    int getNumChannels() const { return m_iNumChannels; }
+    Format getFormat() const { return m_format; }
+    size_t getMemoryFootprint() const { return (size_t) m_iNumChannels * (size_t) m_iLength * (size_t) m_iBytesPerSample; }
+
+    // the longest delay a read can use, the interpolator needs a few samples more
+    int getMaxDelay() const { return m_iLength - m_iMaxBlockSize - kiInterpolationTaps; }
+
+    // copies a block in at the write position, the position moves on with advance()
+    void write (int iChannel, const float* pfSrc, int iNumSamples);
+
+    // reads a block iDelay samples behind the block just written
+    void read (int iChannel, float* pfDest, int iNumSamples, int iDelay) const;
+
+    // same with a fractional delay, third order Lagrange interpolated
+    void readFractional (int iChannel, float* pfDest, int iNumSamples, float fDelay);
+
+    // same with a per sample fractional delay
+    void readInterpolated (int iChannel, float* pfDest, int iNumSamples, const float* pfDelay) const;
+
+    void advance (int iNumSamples)
+    {
+        m_iWriteIdx = (m_iWriteIdx + iNumSamples) & m_iMask;
+        m_iWritten.store (m_iWritten.load (std::memory_order_relaxed) + iNumSamples, std::memory_order_release);
+    }
+
+private:
+    static constexpr int kiInterpolationTaps = 4;
+
+    static int lengthFor (int iMaxDelay, int iMaxBlockSize);
+
+    // first tap of the interpolator and the delay measured from it, in [0, 2)
+    static int splitDelay (float fDelay, float& fFrac);
+
+    // iNumSamples from ring index iIdx on, wrapping, converted from or to the storage format
+    void load (int iChannel, int iIdx, float* pfDest, int iNumSamples) const;
+    void store (int iChannel, int iIdx, const float* pfSrc, int iNumSamples);
+    char* getChannel (int iChannel) const { return m_data + (size_t) iChannel * (size_t) m_iLength * (size_t) m_iBytesPerSample; }
+
+    template <typename Sample>
+    void readFarrow (const Sample& sample, float* pfDest, int iNumSamples, const float* pfDelay) const;
+
+    juce::HeapBlock<char> m_data;
+    juce::HeapBlock<float> m_fScratch;
+    FirKernel::Function m_fir = nullptr;    // fixed fractional delays, for this block size and CPU
+    Format m_format = Format::float32;
+    int m_iBytesPerSample = sizeof (float);
+    int m_iNumChannels = 0;
+    int m_iLength = 0;
+    int m_iMask = 0;
+    int m_iMaxBlockSize = 0;
+    int m_iWriteIdx = 0;    // always m_iWritten & m_iMask
+    std::atomic<juce::int64> m_iWritten { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayLine)
+};
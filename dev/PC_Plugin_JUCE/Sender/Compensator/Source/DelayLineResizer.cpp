@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    DelayLineResizer.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayLineResizer.h"
+
+DelayLineResizer::DelayLineResizer()
+    : juce::Thread ("DelayLineResizer")
+{
+}
+
+DelayLineResizer::~DelayLineResizer()
+{
+    stopThread (1000);
+    reset();
+}
+
+void DelayLineResizer::request (int iNumChannels, int iMaxDelay, int iMaxBlockSize, DelayLine::Format format)
+{
+    m_iChannels = iNumChannels;
+    m_format = format;
+    m_iMaxDelay = iMaxDelay;
+    m_iMaxBlockSize = iMaxBlockSize;
+    m_bRequested = true;
+}
+
+DelayLine* DelayLineResizer::collect()
+{
+    DelayLine* pLine = m_pReady.exchange (nullptr);
+
+    // counted by the processor from now on
+    if (pLine != nullptr)
+        m_iPendingBytes -= pLine->getMemoryFootprint();
+    return pLine;
+}
+
+void DelayLineResizer::retire (DelayLine* pLine)
+{
+    for (auto& slot : m_pRetired)
+    {
+        DelayLine* pExpected = nullptr;
+        if (slot.compare_exchange_strong (pExpected, pLine))
+            return;
+    }
+
+    // more resizes than the background thread could keep up with
+    jassertfalse;
+}
+
+void DelayLineResizer::reset()
+{
+    const juce::ScopedLock sl (m_copyLock);
+    m_pSource = nullptr;
+    m_bRequested = false;
+    delete m_pReady.exchange (nullptr);
+    m_iPendingBytes = 0;
+    freeRetired();
+}
+
+void DelayLineResizer::freeRetired()
+{
+    for (auto& slot : m_pRetired)
+        delete slot.exchange (nullptr);
+}
+
+void DelayLineResizer::run()
+{
+    // polled rather than notified, so request() stays safe to call from the audio thread
+    while (! threadShouldExit())
+    {
+        freeRetired();
+
+        {
+            // a source retired meanwhile is only freed by this thread, after the copy
+            const juce::ScopedLock sl (m_copyLock);
+            const DelayLine* pSource = m_pSource;
+            if (pSource != nullptr && m_bRequested.exchange (false))
+            {
+                auto pLine = std::make_unique<DelayLine>();
+                pLine->prepare (m_iChannels, m_iMaxDelay, m_iMaxBlockSize, m_format);
+                m_iPendingBytes += pLine->getMemoryFootprint();
+                copyHistory (*pLine, *pSource);
+
+                // a line the audio thread did not pick up yet is superseded by the new one
+                if (DelayLine* pSuperseded = m_pReady.exchange (pLine.release()))
+                {
+                    m_iPendingBytes -= pSuperseded->getMemoryFootprint();
+                    delete pSuperseded;
+                }
+            }
+        }
+
+        wait (50);
+    }
+}
+
+void DelayLineResizer::copyHistory (DelayLine& line, const DelayLine& source)
+{
+    // everything the source can still read, then what was written while copying
+    juce::int64 iCopied = source.getNumWritten();
+    line.copyHistoryFrom (source, iCopied - source.getLength(), iCopied);
+
+    for (int iPass = 0; iPass < kiMaxCatchUpPasses; ++iPass)
+    {
+        const juce::int64 iWritten = source.getNumWritten();
+        if (iWritten - iCopied <= m_iMaxBlockSize)
+            break;
+        line.copyHistoryFrom (source, iCopied, iWritten);
+        iCopied = iWritten;
+    }
+
+    // the audio thread copies the rest when it adopts the line
+    line.continueFrom (iCopied);
+}
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    DelayLineResizer.h
+    Allocates new delay lines off the audio thread.
+
+    When the maximum delay is raised or the storage format changes while
+    playing, a new line is requested here. The background thread also copies
+    the history of the line in use into it, and keeps catching up with what
+    the audio thread writes meanwhile until less than a block is missing. The
+    audio thread picks the line up with an atomic exchange, copies that last
+    bit and hands the old one back to be freed, so it never allocates, frees
+    or copies more than a few blocks itself.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayLine.h"
+
+class DelayLineResizer  : private juce::Thread
+{
+public:
+    DelayLineResizer();
+    ~DelayLineResizer() override;
+
+    void start() { startThread (juce::Thread::Priority::low); }
+
+    // any thread, never blocks. The latest request wins
+    void request (int iNumChannels, int iMaxDelay, int iMaxBlockSize, DelayLine::Format format);
+
+    // audio thread: a prepared line, or nullptr when none is ready
+    DelayLine* collect();
+
+    // audio thread: gives a line back to be freed on the background thread
+    void retire (DelayLine* pLine);
+
+    // audio thread, or while it is stopped: the line in use, new ones copy their history from it
+    void setSource (DelayLine* pLine) { m_pSource = pLine; }
+
+    // drops requests and lines in flight, waits for a copy in progress. Call
+    // while the audio thread is stopped and before the line in use is deleted
+    void reset();
+
+    // lines allocated but not yet collected, for the memory report
+    size_t getPendingFootprint() const { return m_iPendingBytes; }
+
+private:
+    void run() override;
+    void freeRetired();
+    void copyHistory (DelayLine& line, const DelayLine& source);
+
+    static constexpr int kiMaxRetired = 8;
+    // copies of what the audio thread wrote during the previous copy, before giving up on getting within a block
+    static constexpr int kiMaxCatchUpPasses = 8;
+
+    std::atomic<bool> m_bRequested { false };
+    std::atomic<int> m_iChannels { 0 }, m_iMaxDelay { 0 }, m_iMaxBlockSize { 0 };
+    std::atomic<DelayLine::Format> m_format { DelayLine::Format::float32 };
+
+    std::atomic<DelayLine*> m_pSource { nullptr };
+    std::atomic<DelayLine*> m_pReady { nullptr };
+    // held while a line is built from the source, so reset() can wait for it
+    juce::CriticalSection m_copyLock;
+    std::atomic<DelayLine*> m_pRetired[kiMaxRetired] {};
+    std::atomic<size_t> m_iPendingBytes { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayLineResizer)
+};
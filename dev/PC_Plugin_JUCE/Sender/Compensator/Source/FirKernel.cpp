@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    FirKernel.cpp
+
+  ==============================================================================
+*/
+
+#include "FirKernel.h"
+#include "../../Shared/KernelDispatch.h"
+
+namespace
+{
+    forcedinline void fir (float* __restrict pfDest, const float* __restrict pfX, const float* pfH, int iNumSamples)
+    {
+        const float h0 = pfH[0], h1 = pfH[1], h2 = pfH[2], h3 = pfH[3];
+        for (int i = 0; i < iNumSamples; ++i)
+            pfDest[i] = h0 * pfX[i + 3] + h1 * pfX[i + 2] + h2 * pfX[i + 1] + h3 * pfX[i];
+    }
+
+    template <int kiBlock>
+    struct Fir
+    {
+        static void baseline (float* pfDest, const float* pfX, const float* pfH, int iNumSamples)
+        {
+            if (kiBlock > 0 && iNumSamples == kiBlock)
+                fir (pfDest, pfX, pfH, kiBlock);
+            else
+                fir (pfDest, pfX, pfH, iNumSamples);
+        }
+
+       #if KERNEL_DISPATCH_HAS_AVX2
+        // with FMA the four products and sums per sample contract to fused multiply-adds
+        static KERNEL_DISPATCH_TARGET ("avx2,fma") void avx2 (float* pfDest, const float* pfX, const float* pfH, int iNumSamples)
+        {
+            if (kiBlock > 0 && iNumSamples == kiBlock)
+                fir (pfDest, pfX, pfH, kiBlock);
+            else
+                fir (pfDest, pfX, pfH, iNumSamples);
+        }
+       #endif
+    };
+}
+
+FirKernel::Function FirKernel::select (int iBlockSize)
+{
+    static const bool bAvx2 = KernelDispatch::canUseAvx2 (true);
+    return KernelDispatch::select<Fir> (iBlockSize, bAvx2);
+}
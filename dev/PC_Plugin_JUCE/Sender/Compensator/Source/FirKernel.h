@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    FirKernel.h
+    The 4 tap FIR behind every fixed fractional delay read, picked per host.
+
+    Four taps are too few to vectorise across, so the loop vectorises across
+    output samples, which a constant block length lets the compiler do
+    without a remainder. The AVX2 build also needs FMA, the taps then cost a
+    multiply and three fused multiply-adds per eight samples. Variants and
+    their choice come from KernelDispatch.h, the SSE2 or NEON baseline covers
+    the rest.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace FirKernel
+{
+    // pfDest[i] = pfH[0] * pfX[i + 3] + pfH[1] * pfX[i + 2] + pfH[2] * pfX[i + 1] + pfH[3] * pfX[i]
+    using Function = void (*) (float* pfDest, const float* pfX, const float* pfH, int iNumSamples);
+
+    // cheap, but call where the block size is known, prepare() or prepareToPlay()
+    Function select (int iBlockSize);
+}
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    LatencyMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LatencyMeter.h"
+
+LatencyMeter::LatencyMeter()
+    : juce::Thread ("LatencyMeter")
+{
+}
+
+LatencyMeter::~LatencyMeter()
+{
+    stopThread (2000);
+}
+
+void LatencyMeter::prepare (double sampleRate)
+{
+    // a measurement still being analysed would read the buffers reallocated here
+    stopThread (2000);
+
+    m_state = State::idle;
+    m_bStartRequested = false;
+    m_dSampleRate = sampleRate;
+
+    // about 0.7 s of probe at any rate: 2^15 - 1 samples at 48 kHz, 2^16 - 1 at 96 kHz
+    const int iOrder = juce::jlimit (12, 18, juce::roundToInt (std::log2 (sampleRate * 0.68)));
+    generateProbe (iOrder);
+
+    m_iCaptureLength = m_iProbeLength + (int) (kfMaxLatencySec * sampleRate);
+    m_fCapture.allocate ((size_t) m_iCaptureLength, true);
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void LatencyMeter::generateProbe (int iOrder)
+{
+    // feedback masks of maximal length Galois LFSRs
+    static const juce::uint32 kiTaps[] = { 0xE08, 0x1C80, 0x3802, 0x6000, 0xB400, 0x12000, 0x20400 };
+
+    m_iProbeLength = (1 << iOrder) - 1;
+    m_fProbe.allocate ((size_t) m_iProbeLength, false);
+
+    juce::uint32 iState = 1;
+    for (int i = 0; i < m_iProbeLength; ++i)
+    {
+        const bool bOut = (iState & 1) != 0;
+        iState >>= 1;
+        if (bOut)
+            iState ^= kiTaps[iOrder - 12];
+        m_fProbe[i] = bOut ? kfProbeGain : -kfProbeGain;
+    }
+}
+
+void LatencyMeter::start()
+{
+    if (m_iProbeLength > 0 && m_state != State::probing && m_state != State::analysing)
+        m_bStartRequested = true;
+}
+
+void LatencyMeter::process (float* const* ppfOutput, int iNumOutput, const float* const* ppfReturn, int iNumReturn, int iNumSamples)
+{
+    if (m_bStartRequested.exchange (false))
+    {
+        m_iPosition = 0;
+        m_state = State::probing;
+    }
+
+    if (m_state != State::probing)
+        return;
+
+    const int iNum = juce::jmin (iNumSamples, m_iCaptureLength - m_iPosition);
+
+    // record the return first, the output may share its memory when processing in place
+    if (iNumReturn > 0)
+    {
+        float* pfCapture = m_fCapture + m_iPosition;
+        juce::FloatVectorOperations::copy (pfCapture, ppfReturn[0], iNum);
+        for (int ch = 1; ch < iNumReturn; ++ch)
+            juce::FloatVectorOperations::add (pfCapture, ppfReturn[ch], iNum);
+    }
+    else
+    {
+        juce::FloatVectorOperations::clear (m_fCapture + m_iPosition, iNum);
+    }
+
+    // probe while it lasts, then silence so the echo is not masked by program material
+    const int iProbed = juce::jlimit (0, iNum, m_iProbeLength - m_iPosition);
+    for (int ch = 0; ch < iNumOutput; ++ch)
+    {
+        juce::FloatVectorOperations::copy (ppfOutput[ch], m_fProbe + m_iPosition, iProbed);
+        juce::FloatVectorOperations::clear (ppfOutput[ch] + iProbed, iNumSamples - iProbed);
+    }
+
+    m_iPosition += iNum;
+    if (m_iPosition >= m_iCaptureLength)
+        m_state = State::analysing;
+}
+
+DelayEstimator::Result LatencyMeter::getResult() const
+{
+    const juce::ScopedLock sl (m_resultLock);
+    return m_result;
+}
+
+void LatencyMeter::run()
+{
+    // polled, so the audio thread never has to signal anything
+    while (! threadShouldExit())
+    {
+        if (m_state == State::analysing)
+        {
+            m_estimator.prepare (m_iProbeLength, m_iCaptureLength - m_iProbeLength);
+            const auto result = m_estimator.estimate (m_fProbe, m_iProbeLength, m_fCapture, m_iCaptureLength);
+
+            {
+                const juce::ScopedLock sl (m_resultLock);
+                m_result = result;
+            }
+
+            m_state = result.fConfidence >= kfMinConfidence ? State::done : State::failed;
+            if (onFinished != nullptr)
+                onFinished();
+        }
+
+        wait (50);
+    }
+}
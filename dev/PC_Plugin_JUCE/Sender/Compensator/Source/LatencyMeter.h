@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    LatencyMeter.h
+    One-shot round trip latency measurement.
+
+    While measuring, the outgoing signal is replaced by a maximum length
+    sequence and the returned signal is recorded. An MLS has a flat spectrum
+    and a single sharp autocorrelation peak, so after the remote codec and
+    effects the lag is still found to the sample. The correlation runs on the
+    meter's own thread, the audio thread only copies samples.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayEstimator.h"
+
+class LatencyMeter  : private juce::Thread
+{
+public:
+    enum class State { idle, probing, analysing, done, failed };
+
+    // round trips longer than this are not searched for
+    static constexpr double kfMaxLatencySec = 2.0;
+
+    // below this the measurement is reported as failed instead of applied
+    static constexpr float kfMinConfidence = 0.5f;
+
+    LatencyMeter();
+    ~LatencyMeter() override;
+
+    // allocates the probe and the capture buffer, call from prepareToPlay
+    void prepare (double sampleRate);
+
+    // any thread, the probe starts with the next audio block
+    void start();
+
+    // audio thread: while probing, replaces the output with the probe and records the return
+    void process (float* const* ppfOutput, int iNumOutput, const float* const* ppfReturn, int iNumReturn, int iNumSamples);
+
+    State getState() const { return m_state; }
+    DelayEstimator::Result getResult() const;
+    double getSampleRate() const { return m_dSampleRate; }
+
+    // called on the meter thread when the state turned to done or failed
+    std::function<void()> onFinished;
+
+private:
+    void run() override;
+    void generateProbe (int iOrder);
+
+    // -12 dBFS, loud enough for the return path, gentle on monitors
+    static constexpr float kfProbeGain = 0.25f;
+
+    std::atomic<State> m_state { State::idle };
+    std::atomic<bool> m_bStartRequested { false };
+
+    juce::HeapBlock<float> m_fProbe, m_fCapture;
+    int m_iProbeLength = 0;
+    int m_iCaptureLength = 0;
+    int m_iPosition = 0;
+    double m_dSampleRate = 0.0;
+
+    DelayEstimator m_estimator;
+    juce::CriticalSection m_resultLock;
+    DelayEstimator::Result m_result;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyMeter)
+};
@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    LatencyTracker.cpp
+
+  ==============================================================================
+*/
+
+#include "LatencyTracker.h"
+
+namespace
+{
+    // mean square below which a window carries too little signal to correlate
+    constexpr float kfMinEnergy = 1.0e-7f;
+}
+
+LatencyTracker::LatencyTracker()
+    : juce::Thread ("LatencyTracker")
+{
+}
+
+LatencyTracker::~LatencyTracker()
+{
+    stopThread (2000);
+}
+
+void LatencyTracker::prepare (double sampleRate, int iMaxLag)
+{
+    stopThread (2000);
+
+    // about 85 ms partitions: 4096 samples at 48 kHz
+    m_iPartition = juce::nextPowerOfTwo ((int) (sampleRate * 0.064));
+    m_iNumRefParts = juce::jmax (1, (int) std::ceil (kfWindowSec * sampleRate / m_iPartition));
+    m_iNumLagBlocks = juce::jmax (1, (iMaxLag + m_iPartition - 1) / m_iPartition);
+    m_iNumSlots = m_iNumRefParts + m_iNumLagBlocks;
+
+    const int iFftSize = 2 * m_iPartition;
+    m_fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 ((double) iFftSize)));
+
+    // FFT buffers hold 2 * size floats, the spectra only use size + 2 of them
+    m_refSpectra.setSize (m_iNumSlots, 2 * iFftSize);
+    m_retSpectra.setSize (m_iNumSlots, 2 * iFftSize);
+    m_fRefEnergy.allocate ((size_t) m_iNumSlots, true);
+    m_fRetEnergy.allocate ((size_t) m_iNumSlots, true);
+    m_fPartRef.allocate ((size_t) m_iPartition, true);
+    m_fPartRet.allocate ((size_t) m_iPartition, true);
+    m_fPrevRet.allocate ((size_t) m_iPartition, true);
+    m_fAccum.allocate ((size_t) (2 * iFftSize), true);
+    m_fCorrelation.allocate ((size_t) (m_iNumLagBlocks * m_iPartition), true);
+    m_iNumPartitions = 0;
+    m_dLastConfidentLag = -1.0;
+
+    // a second of audio between the two threads
+    const int iFifoSize = juce::nextPowerOfTwo ((int) sampleRate);
+    m_fifo = std::make_unique<juce::AbstractFifo> (iFifoSize);
+    m_fifoData.setSize (2, iFifoSize);
+
+    {
+        const juce::ScopedLock sl (m_resultLock);
+        m_latest = {};
+    }
+
+    startThread (juce::Thread::Priority::low);
+}
+
+void LatencyTracker::push (const float* const* ppfReference, int iNumReference,
+                           const float* const* ppfReturn, int iNumReturn, int iNumSamples)
+{
+    if (! m_bEnabled || m_fifo == nullptr || iNumReference == 0 || iNumReturn == 0)
+        return;
+
+    // when the tracker thread falls behind both signals lose the same samples and stay aligned
+    if (m_fifo->getFreeSpace() < iNumSamples)
+        return;
+
+    int iStart1, iSize1, iStart2, iSize2;
+    m_fifo->prepareToWrite (iNumSamples, iStart1, iSize1, iStart2, iSize2);
+
+    auto mixDown = [] (float* pfDest, const float* const* ppfSrc, int iNumChannels, int iOffset, int iNum)
+    {
+        juce::FloatVectorOperations::copy (pfDest, ppfSrc[0] + iOffset, iNum);
+        for (int ch = 1; ch < iNumChannels; ++ch)
+            juce::FloatVectorOperations::add (pfDest, ppfSrc[ch] + iOffset, iNum);
+    };
+
+    mixDown (m_fifoData.getWritePointer (0, iStart1), ppfReference, iNumReference, 0, iSize1);
+    mixDown (m_fifoData.getWritePointer (1, iStart1), ppfReturn, iNumReturn, 0, iSize1);
+    if (iSize2 > 0)
+    {
+        mixDown (m_fifoData.getWritePointer (0, iStart2), ppfReference, iNumReference, iSize1, iSize2);
+        mixDown (m_fifoData.getWritePointer (1, iStart2), ppfReturn, iNumReturn, iSize1, iSize2);
+    }
+
+    m_fifo->finishedWrite (iSize1 + iSize2);
+}
+
+DelayEstimator::Result LatencyTracker::getLatest() const
+{
+    const juce::ScopedLock sl (m_resultLock);
+    return m_latest;
+}
+
+void LatencyTracker::run()
+{
+    int iFilled = 0;
+    bool bWasEnabled = false;
+    juce::uint32 iLastAnalysis = 0;
+
+    while (! threadShouldExit())
+    {
+        // after a pause the stored partitions no longer line up with new ones
+        const bool bEnabled = m_bEnabled;
+        if (bEnabled && ! bWasEnabled)
+        {
+            m_fifo->finishedRead (m_fifo->getNumReady());
+            m_iNumPartitions = 0;
+            m_dLastConfidentLag = -1.0;
+            iFilled = 0;
+        }
+        bWasEnabled = bEnabled;
+
+        // move whatever arrived into partitions
+        while (m_fifo->getNumReady() > 0)
+        {
+            const int iWanted = m_iPartition - iFilled;
+            int iStart1, iSize1, iStart2, iSize2;
+            m_fifo->prepareToRead (iWanted, iStart1, iSize1, iStart2, iSize2);
+
+            juce::FloatVectorOperations::copy (m_fPartRef + iFilled, m_fifoData.getReadPointer (0, iStart1), iSize1);
+            juce::FloatVectorOperations::copy (m_fPartRet + iFilled, m_fifoData.getReadPointer (1, iStart1), iSize1);
+            juce::FloatVectorOperations::copy (m_fPartRef + iFilled + iSize1, m_fifoData.getReadPointer (0, iStart2), iSize2);
+            juce::FloatVectorOperations::copy (m_fPartRet + iFilled + iSize1, m_fifoData.getReadPointer (1, iStart2), iSize2);
+            m_fifo->finishedRead (iSize1 + iSize2);
+
+            iFilled += iSize1 + iSize2;
+            if (iFilled == m_iPartition)
+            {
+                addPartition (m_fPartRef, m_fPartRet);
+                iFilled = 0;
+            }
+        }
+
+        // the analysis rate bounds the CPU spent on correlations
+        const auto iNow = juce::Time::getMillisecondCounter();
+        const auto iInterval = (juce::uint32) (1000.0f / juce::jmax (0.01f, m_fAnalysisRate.load()));
+        if (bEnabled && m_iNumPartitions >= m_iNumSlots && iNow - iLastAnalysis >= iInterval)
+        {
+            iLastAnalysis = iNow;
+            analyse();
+        }
+
+        wait (20);
+    }
+}
+
+void LatencyTracker::transformAndWhiten (float* pfSpectrum)
+{
+    m_fft->performRealOnlyForwardTransform (pfSpectrum, true);
+
+    auto* pBins = reinterpret_cast<std::complex<float>*> (pfSpectrum);
+    for (int k = 0; k <= m_iPartition; ++k)
+    {
+        const float fMagnitude = std::abs (pBins[k]);
+        pBins[k] = fMagnitude > 1.0e-20f ? pBins[k] / std::pow (fMagnitude, DelayEstimator::kfPhatBeta) : std::complex<float>();
+    }
+}
+
+void LatencyTracker::addPartition (const float* pfReference, const float* pfReturn)
+{
+    const int iFftSize = 2 * m_iPartition;
+    const int iSlot = (int) (m_iNumPartitions % m_iNumSlots);
+
+    // reference partition t, zero padded
+    float* pfRef = m_refSpectra.getWritePointer (iSlot);
+    juce::FloatVectorOperations::clear (pfRef, 2 * iFftSize);
+    juce::FloatVectorOperations::copy (pfRef, pfReference, m_iPartition);
+    float fRefEnergy = 0.0f, fRetEnergy = 0.0f;
+    for (int i = 0; i < m_iPartition; ++i)
+    {
+        fRefEnergy += pfReference[i] * pfReference[i];
+        fRetEnergy += pfReturn[i] * pfReturn[i];
+    }
+    m_fRefEnergy[iSlot] = fRefEnergy / m_iPartition;
+    transformAndWhiten (pfRef);
+
+    // return partitions t - 1 and t, stored in the slot of t - 1 so it lines up with reference t - 1
+    if (m_iNumPartitions > 0)
+    {
+        const int iPrevSlot = (int) ((m_iNumPartitions - 1) % m_iNumSlots);
+        float* pfRet = m_retSpectra.getWritePointer (iPrevSlot);
+        juce::FloatVectorOperations::clear (pfRet, 2 * iFftSize);
+        juce::FloatVectorOperations::copy (pfRet, m_fPrevRet, m_iPartition);
+        juce::FloatVectorOperations::copy (pfRet + m_iPartition, pfReturn, m_iPartition);
+        transformAndWhiten (pfRet);
+    }
+    m_fRetEnergy[iSlot] = fRetEnergy / m_iPartition;
+    juce::FloatVectorOperations::copy (m_fPrevRet, pfReturn, m_iPartition);
+
+    ++m_iNumPartitions;
+}
+
+void LatencyTracker::analyse()
+{
+    // newest complete return spectrum is partition T - 1, so the reference
+    // window starts where every lag block still has its return partition
+    const juce::int64 iLast = m_iNumPartitions - 1;
+    const juce::int64 iFirst = iLast - (m_iNumRefParts + m_iNumLagBlocks) + 1;
+
+    float fRefEnergy = 0.0f, fRetEnergy = 0.0f;
+    for (juce::int64 t = iFirst; t <= iLast; ++t)
+    {
+        const int iSlot = (int) (t % m_iNumSlots);
+        fRefEnergy += t < iFirst + m_iNumRefParts ? m_fRefEnergy[iSlot] : 0.0f;
+        fRetEnergy += m_fRetEnergy[iSlot];
+    }
+    if (fRefEnergy / m_iNumRefParts < kfMinEnergy || fRetEnergy / m_iNumSlots < kfMinEnergy)
+        return;
+
+    const int iFftSize = 2 * m_iPartition;
+    for (int j = 0; j < m_iNumLagBlocks; ++j)
+    {
+        // lags j * P .. (j + 1) * P - 1, summed over the reference partitions
+        auto* pAccum = reinterpret_cast<std::complex<float>*> (m_fAccum.getData());
+        juce::FloatVectorOperations::clear (m_fAccum, 2 * iFftSize);
+
+        for (int i = 0; i < m_iNumRefParts; ++i)
+        {
+            const auto* pRef = reinterpret_cast<const std::complex<float>*> (m_refSpectra.getReadPointer ((int) ((iFirst + i) % m_iNumSlots)));
+            const auto* pRet = reinterpret_cast<const std::complex<float>*> (m_retSpectra.getReadPointer ((int) ((iFirst + i + j) % m_iNumSlots)));
+            for (int k = 0; k <= m_iPartition; ++k)
+                pAccum[k] += pRet[k] * std::conj (pRef[k]);
+        }
+
+        m_fft->performRealOnlyInverseTransform (m_fAccum);
+        juce::FloatVectorOperations::copy (m_fCorrelation + j * m_iPartition, m_fAccum, m_iPartition);
+    }
+
+    const auto result = DelayEstimator::findPeak (m_fCorrelation, m_iNumLagBlocks * m_iPartition);
+    {
+        const juce::ScopedLock sl (m_resultLock);
+        m_latest = result;
+    }
+
+    if (result.fConfidence < kfMinConfidence)
+    {
+        m_dLastConfidentLag = -1.0;
+        return;
+    }
+
+    // one confident estimate can still be a repetition in the music, wait for a second one
+    if (m_dLastConfidentLag >= 0.0 && std::abs (result.dLag - m_dLastConfidentLag) <= 1.0 && onStableEstimate != nullptr)
+        onStableEstimate (result.dLag);
+
+    m_dLastConfidentLag = result.dLag;
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    LatencyTracker.h
+    Follows the round trip latency while live audio flows.
+
+    The audio thread only copies the reference (the Compensator's input, what
+    the Sender transmits) and the returned signal into a FIFO. The tracker's
+    thread cuts both into partitions, transforms and whitens each partition
+    once as it arrives, and at the configured analysis rate sums the partition
+    cross spectra into a GCC-PHAT correlation over the whole lag range. So the
+    cost is a few small FFTs per partition plus one pass over the stored
+    spectra per analysis, however long the lag range is.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayEstimator.h"
+
+class LatencyTracker  : private juce::Thread
+{
+public:
+    // length of reference audio correlated per analysis
+    static constexpr double kfWindowSec = 0.5;
+
+    // estimates below this are shown but never applied
+    static constexpr float kfMinConfidence = 0.6f;
+
+    LatencyTracker();
+    ~LatencyTracker() override;
+
+    // allocates, call from prepareToPlay. Lags 0 .. iMaxLag samples are searched
+    void prepare (double sampleRate, int iMaxLag);
+
+    // any thread
+    void setEnabled (bool bEnabled)        { m_bEnabled = bEnabled; }
+    void setAnalysisRate (float fHz)       { m_fAnalysisRate = fHz; }
+    bool isEnabled() const                 { return m_bEnabled; }
+
+    // audio thread: mono sums of both signals go to the FIFO, nothing else
+    void push (const float* const* ppfReference, int iNumReference,
+               const float* const* ppfReturn, int iNumReturn, int iNumSamples);
+
+    // the last analysis, confident or not
+    DelayEstimator::Result getLatest() const;
+
+    // called on the tracker thread when two confident estimates in a row agree
+    std::function<void (double dLag)> onStableEstimate;
+
+private:
+    void run() override;
+    void addPartition (const float* pfReference, const float* pfReturn);
+    void analyse();
+    void transformAndWhiten (float* pfSpectrum);
+
+    std::atomic<bool> m_bEnabled { false };
+    std::atomic<float> m_fAnalysisRate { 1.0f };
+
+    // audio thread -> tracker thread, channel 0 reference, channel 1 return
+    std::unique_ptr<juce::AbstractFifo> m_fifo;
+    juce::AudioBuffer<float> m_fifoData;
+
+    // tracker thread only
+    std::unique_ptr<juce::dsp::FFT> m_fft;
+    int m_iPartition = 0;           // samples per partition, FFTs are twice as long
+    int m_iNumRefParts = 0;         // partitions in a reference window
+    int m_iNumLagBlocks = 0;        // partitions in the lag range
+    int m_iNumSlots = 0;
+    juce::AudioBuffer<float> m_refSpectra, m_retSpectra;
+    juce::HeapBlock<float> m_fRefEnergy, m_fRetEnergy;
+    juce::HeapBlock<float> m_fPartRef, m_fPartRet, m_fPrevRet, m_fAccum, m_fCorrelation;
+    juce::int64 m_iNumPartitions = 0;
+    double m_dLastConfidentLag = -1.0;
+
+    juce::CriticalSection m_resultLock;
+    DelayEstimator::Result m_latest;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LatencyTracker)
+};
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    OscControl.cpp
+
+  ==============================================================================
+*/
+
+#include "OscControl.h"
+
+OscControl::OscControl()
+    : juce::Thread ("OscControl")
+{
+}
+
+OscControl::~OscControl()
+{
+    stopThread (1000);
+}
+
+int OscControl::addSlot (const char* pAddress, SlotType type)
+{
+    jassert (! isThreadRunning() && m_iNumSlots < kiMaxSlots);
+    m_slots[m_iNumSlots].type = type;
+    m_addresses.add (pAddress, m_iNumSlots);
+    return m_iNumSlots++;
+}
+
+bool OscControl::pop (Event& event)
+{
+    if (m_fifo.getNumReady() == 0)
+        return false;
+
+    int iStart1, iSize1, iStart2, iSize2;
+    m_fifo.prepareToRead (1, iStart1, iSize1, iStart2, iSize2);
+    event = m_events[iStart1];
+    m_fifo.finishedRead (1);
+    return true;
+}
+
+void OscControl::run()
+{
+    juce::DatagramSocket socket;
+    alignas (8) char buffer[kiMaxDatagram];
+
+    while (! threadShouldExit())
+    {
+        if (! m_bListening)
+        {
+            m_bListening = socket.bindToPort (kiPort);
+            if (! m_bListening)
+            {
+                wait (1000);
+                continue;
+            }
+        }
+
+        // wake up regularly so stopThread() never waits on a silent socket
+        if (socket.waitUntilReady (true, 50) <= 0)
+            continue;
+
+        const int iSize = socket.read (buffer, kiMaxDatagram, false);
+        if (iSize <= 0)
+            continue;
+
+        bool bQueued = false;
+        if (! Osc::decode (buffer, iSize, [this, &bQueued] (const Osc::MessageView& message, juce::uint64 iTimetag)
+                                          { bQueued |= handleMessage (message, iTimetag); }))
+            ++m_iMalformed;
+
+        if (bQueued && onValue)
+            onValue();
+    }
+
+    socket.shutdown();
+    m_bListening = false;
+}
+
+bool OscControl::handleMessage (const Osc::MessageView& message, juce::uint64 iTimetag)
+{
+    if (! Osc::isPattern (message.pAddress, message.iAddressLength))
+    {
+        const int iSlot = m_addresses.find (message.pAddress, message.iAddressLength);
+        return iSlot >= 0 && queueSlot (iSlot, message, iTimetag);
+    }
+
+    // a pattern such as "/juce/delay/*" can reach a slot along several paths, each one is set once
+    static_assert (kiMaxSlots <= 64, "matched slots are collected in a 64 bit mask");
+    juce::uint64 iMatched = 0;
+    m_addresses.forEachMatch (message.pAddress, message.iAddressLength,
+                              [&iMatched] (int iSlot) { iMatched |= (juce::uint64) 1 << iSlot; });
+
+    bool bQueued = false;
+    for (int iSlot = 0; iSlot < m_iNumSlots; ++iSlot)
+        if ((iMatched >> iSlot) & 1)
+            bQueued |= queueSlot (iSlot, message, iTimetag);
+    return bQueued;
+}
+
+bool OscControl::queueSlot (int iSlot, const Osc::MessageView& message, juce::uint64 iTimetag)
+{
+    Slot& slot = m_slots[iSlot];
+    Event event;
+    event.iSlot = iSlot;
+    event.iReceivedTicks = juce::Time::getHighResolutionTicks();
+    event.iTimetag = iTimetag;
+
+    float fValue = 1.0f;
+    if (slot.type != SlotType::trigger && ! message.getFirstNumber (fValue))
+    {
+        ++m_iMalformed;
+        return false;
+    }
+
+    switch (slot.type)
+    {
+        case SlotType::normalised: event.fValue = juce::jlimit (0.0f, 1.0f, fValue); break;
+        case SlotType::toggle:     event.fValue = fValue > 0.5f ? 1.0f : 0.0f; break;
+        case SlotType::trigger:    event.fValue = 1.0f; break;
+        case SlotType::value:      event.fValue = fValue; break;
+    }
+
+    slot.fLatest = event.fValue;
+    slot.bChanged = true;
+
+    // a full queue means the audio thread is not running, the latest value still reaches the host
+    if (m_fifo.getFreeSpace() == 0)
+    {
+        ++m_iDropped;
+        return true;
+    }
+
+    int iStart1, iSize1, iStart2, iSize2;
+    m_fifo.prepareToWrite (1, iStart1, iSize1, iStart2, iSize2);
+    m_events[iStart1] = event;
+    m_fifo.finishedWrite (1);
+    return true;
+}
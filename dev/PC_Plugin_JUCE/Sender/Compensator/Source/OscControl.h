@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    OscControl.h
+    Receives remote control over OSC independently of the editor.
+
+    A thread of its own reads the datagrams into a fixed buffer, decodes them
+    in place (see OscParser.h) and queues the values for the audio thread
+    through a single producer / single consumer FIFO, so neither side
+    allocates, locks or waits on the message loop. Every event carries the
+    time it arrived, which lets the audio thread report how long a knob move
+    takes to reach the audio.
+
+    Addresses are registered as typed slots before start(). The latest value
+    of every slot is also kept for the message thread, which shows it to the
+    host.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscParser.h"
+
+class OscControl  : private juce::Thread
+{
+public:
+    // the port the Electron console sends "/juce/<target>" to
+    static constexpr int kiPort = 9001;
+    static constexpr int kiMaxSlots = 64;
+
+    enum class SlotType
+    {
+        normalised,     // any number, clamped to 0 .. 1
+        toggle,         // T/F or a number, above 0.5 is on
+        trigger,        // fires on any message, arguments are ignored
+        value           // any number, passed on as it is
+    };
+
+    struct Event
+    {
+        int iSlot = -1;
+        float fValue = 0.0f;
+        juce::int64 iReceivedTicks = 0; // juce::Time::getHighResolutionTicks()
+        juce::uint64 iTimetag = Osc::kiImmediately;
+    };
+
+    OscControl();
+    ~OscControl() override;
+
+    // allocates, call before start(). Returns the slot index
+    int addSlot (const char* pAddress, SlotType type);
+
+    // binds on the receive thread and keeps retrying while another instance holds the port
+    void start() { startThread (juce::Thread::Priority::high); }
+    bool isStarted() const { return isThreadRunning(); }
+    void stop()  { stopThread (1000); }
+
+    // audio thread: the oldest queued event, false when there is none
+    bool pop (Event& event);
+
+    // message thread: true once per new value of the slot
+    bool fetchChanged (int iSlot)           { return m_slots[iSlot].bChanged.exchange (false); }
+
+    // any thread
+    int getNumSlots() const                 { return m_iNumSlots; }
+    bool isListening() const                { return m_bListening; }
+    float getLatestValue (int iSlot) const  { return m_slots[iSlot].fLatest; }
+    int getDropped() const                  { return m_iDropped; }
+    // datagrams that did not decode, plus one per slot that refused a message without a finite number
+    int getMalformed() const                { return m_iMalformed; }
+
+    // called on the receive thread after a datagram queued at least one event
+    std::function<void()> onValue;
+
+private:
+    void run() override;
+    bool handleMessage (const Osc::MessageView& message, juce::uint64 iTimetag);
+    bool queueSlot (int iSlot, const Osc::MessageView& message, juce::uint64 iTimetag);
+
+    static constexpr int kiQueueSize = 256;
+    static constexpr int kiMaxDatagram = 8192;
+
+    struct Slot
+    {
+        SlotType type = SlotType::normalised;
+        std::atomic<float> fLatest { 0.0f };
+        std::atomic<bool> bChanged { false };
+    };
+
+    Osc::AddressTrie m_addresses;
+    Slot m_slots[kiMaxSlots];
+    int m_iNumSlots = 0;
+
+    juce::AbstractFifo m_fifo { kiQueueSize };
+    Event m_events[kiQueueSize];
+
+    std::atomic<bool> m_bListening { false };
+    std::atomic<int> m_iDropped { 0 };
+    std::atomic<int> m_iMalformed { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OscControl)
+};
@@ -0,0 +1,370 @@
+/*
+  ==============================================================================
+
+    OscParser.h
+    Allocation free OSC 1.0 decoding over the raw datagram.
+
+    Messages and bundles are read where they lie in the receive buffer: the
+    address, the type tags and the arguments are only pointers into it. The
+    addresses a plugin understands are compiled once into a trie, so matching
+    an incoming address costs one step per character and never builds a
+    string. Nested bundles are walked recursively and every message is handed
+    on with the timetag of the bundle that carried it.
+
+    Addresses holding OSC 1.0 pattern characters (* ? [] {}) are matched
+    against the trie as well, by walking it along the pattern. Every trie
+    node is visited at most once per pattern position, so a datagram full of
+    stars costs nodes x pattern length steps instead of growing exponentially,
+    and patterns longer than any sane address are refused outright.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Osc
+{
+    // NTP format, seconds since 1900 in the upper 32 bits. 1 means "immediately"
+    static constexpr juce::uint64 kiImmediately = 1;
+
+    inline juce::uint32 readUInt32 (const char* pData)
+    {
+        juce::uint32 iValue;
+        std::memcpy (&iValue, pData, sizeof (iValue));
+        return juce::ByteOrder::swapIfLittleEndian (iValue);
+    }
+
+    inline juce::uint64 readUInt64 (const char* pData)
+    {
+        juce::uint64 iValue;
+        std::memcpy (&iValue, pData, sizeof (iValue));
+        return juce::ByteOrder::swapIfLittleEndian (iValue);
+    }
+
+    // size of a null terminated string including its padding to four bytes, -1 when it runs past the end
+    inline int paddedStringSize (const char* pData, int iAvailable)
+    {
+        const void* pEnd = std::memchr (pData, 0, (size_t) juce::jmax (0, iAvailable));
+        if (pEnd == nullptr)
+            return -1;
+        const int iSize = ((int) (static_cast<const char*> (pEnd) - pData) + 4) & ~3;
+        return iSize <= iAvailable ? iSize : -1;
+    }
+
+    //==============================================================================
+    // one decoded message, pointing into the datagram
+    struct MessageView
+    {
+        const char* pAddress = nullptr;
+        int iAddressLength = 0;
+        const char* pTypeTags = nullptr;    // without the leading ','
+        const char* pArguments = nullptr;
+        int iArgumentBytes = 0;
+
+        int getNumArguments() const         { return (int) std::strlen (pTypeTags); }
+
+        // the first argument as a number, from any numeric or boolean tag. False when there is
+        // none or it is NaN or infinite, which jlimit would pass straight through
+        bool getFirstNumber (float& fValue) const
+        {
+            if (pTypeTags[0] == 'T' || pTypeTags[0] == 'F')
+            {
+                fValue = pTypeTags[0] == 'T' ? 1.0f : 0.0f;
+                return true;
+            }
+
+            const int iNeeded = (pTypeTags[0] == 'd' || pTypeTags[0] == 'h') ? 8 : 4;
+            if (iArgumentBytes < iNeeded)
+                return false;
+
+            switch (pTypeTags[0])
+            {
+                case 'f':
+                {
+                    const juce::uint32 iBits = readUInt32 (pArguments);
+                    std::memcpy (&fValue, &iBits, sizeof (fValue));
+                    return std::isfinite (fValue);
+                }
+                case 'd':
+                {
+                    const juce::uint64 iBits = readUInt64 (pArguments);
+                    double dValue;
+                    std::memcpy (&dValue, &iBits, sizeof (dValue));
+                    fValue = (float) dValue;
+                    return std::isfinite (fValue);
+                }
+                case 'i': fValue = (float) (juce::int32) readUInt32 (pArguments); return true;
+                case 'h': fValue = (float) (juce::int64) readUInt64 (pArguments); return true;
+                default:  return false;
+            }
+        }
+    };
+
+    //==============================================================================
+    // calls handler (const MessageView&, juce::uint64 timetag) for every well formed
+    // message in the packet. Returns false when the packet is malformed; messages
+    // before the damaged part have been handled by then
+    template <typename Handler>
+    bool decode (const char* pData, int iSize, Handler&& handler,
+                 juce::uint64 iTimetag = kiImmediately, int iDepth = 0)
+    {
+        static constexpr int kiMaxDepth = 8;
+        if (iSize < 4 || (iSize & 3) != 0 || iDepth > kiMaxDepth)
+            return false;
+
+        if (pData[0] == '#')
+        {
+            // "#bundle", timetag, then elements each prefixed by their size
+            if (iSize < 16 || std::memcmp (pData, "#bundle", 8) != 0)
+                return false;
+
+            const juce::uint64 iBundleTime = readUInt64 (pData + 8);
+            for (int iPos = 16; iPos < iSize;)
+            {
+                if (iSize - iPos < 4)
+                    return false;
+                const int iElementSize = (int) readUInt32 (pData + iPos);
+                iPos += 4;
+                if (iElementSize < 0 || iElementSize > iSize - iPos
+                    || ! decode (pData + iPos, iElementSize, handler, iBundleTime, iDepth + 1))
+                    return false;
+                iPos += iElementSize;
+            }
+            return true;
+        }
+
+        if (pData[0] != '/')
+            return false;
+
+        MessageView message;
+        message.pAddress = pData;
+        const int iAddressSize = paddedStringSize (pData, iSize);
+        if (iAddressSize < 0)
+            return false;
+        message.iAddressLength = (int) std::strlen (pData);
+
+        // OSC 1.0 allows a message without type tags, it carries no arguments then
+        static const char kNoTags[] = "";
+        message.pTypeTags = kNoTags;
+        int iPos = iAddressSize;
+        if (iPos < iSize && pData[iPos] == ',')
+        {
+            const int iTagsSize = paddedStringSize (pData + iPos, iSize - iPos);
+            if (iTagsSize < 0)
+                return false;
+            message.pTypeTags = pData + iPos + 1;
+            iPos += iTagsSize;
+        }
+
+        message.pArguments = pData + iPos;
+        message.iArgumentBytes = iSize - iPos;
+        handler (message, iTimetag);
+        return true;
+    }
+
+    // whether an incoming address is an OSC pattern rather than a plain address
+    inline bool isPattern (const char* pAddress, int iLength)
+    {
+        for (int i = 0; i < iLength; ++i)
+            if (pAddress[i] == '*' || pAddress[i] == '?' || pAddress[i] == '[' || pAddress[i] == '{')
+                return true;
+        return false;
+    }
+
+    //==============================================================================
+    // maps addresses to small integer ids. Built once, lookups never allocate
+    class AddressTrie
+    {
+    public:
+        // longer patterns are ignored, the slot addresses are a fraction of this
+        static constexpr int kiMaxPatternLength = 64;
+
+        // allocates, call while setting up
+        void add (const char* pAddress, int iId)
+        {
+            jassert (iId >= 0);
+            if (m_nodes.empty())
+                m_nodes.push_back ({});
+
+            int iNode = 0;
+            for (const char* p = pAddress; *p != '\0'; ++p)
+            {
+                int iChild = findChild (iNode, *p);
+                if (iChild < 0)
+                {
+                    Node node;
+                    node.c = *p;
+                    node.iNextSibling = m_nodes[(size_t) iNode].iFirstChild;
+                    iChild = (int) m_nodes.size();
+                    m_nodes.push_back (node);
+                    m_nodes[(size_t) iNode].iFirstChild = iChild;
+                }
+                iNode = iChild;
+            }
+            m_nodes[(size_t) iNode].iId = iId;
+
+            // one bit per node and pattern position, see matchFrom()
+            m_visited.assign ((m_nodes.size() * (kiMaxPatternLength + 1) + 63) / 64, 0);
+        }
+
+        // the id of an exact match, -1 otherwise
+        int find (const char* pAddress, int iLength) const
+        {
+            if (m_nodes.empty())
+                return -1;
+
+            int iNode = 0;
+            for (int i = 0; i < iLength && iNode >= 0; ++i)
+                iNode = findChild (iNode, pAddress[i]);
+            if (iNode < 0)
+                return -1;
+            return m_nodes[(size_t) iNode].iId;
+        }
+
+        // calls callback (int id) once for every address the pattern matches.
+        // Uses scratch space of the trie, so only one thread may match at a time
+        template <typename Callback>
+        void forEachMatch (const char* pPattern, int iLength, Callback&& callback) const
+        {
+            if (m_nodes.empty() || iLength > kiMaxPatternLength)
+                return;
+
+            std::fill (m_visited.begin(), m_visited.end(), (juce::uint64) 0);
+            matchFrom (0, pPattern, pPattern, pPattern + iLength, callback);
+        }
+
+    private:
+        // pStart is where the pattern begins, for the position in the visited set
+        template <typename Callback>
+        void matchFrom (int iNode, const char* p, const char* pStart, const char* pEnd, Callback& callback) const
+        {
+            // the same node at the same pattern position always matches the same addresses
+            const size_t iState = (size_t) iNode * (kiMaxPatternLength + 1) + (size_t) (p - pStart);
+            juce::uint64& iWord = m_visited[iState / 64];
+            const juce::uint64 iBit = (juce::uint64) 1 << (iState % 64);
+            if ((iWord & iBit) != 0)
+                return;
+            iWord |= iBit;
+
+            if (p == pEnd)
+            {
+                if (m_nodes[(size_t) iNode].iId >= 0)
+                    callback (m_nodes[(size_t) iNode].iId);
+                return;
+            }
+
+            switch (*p)
+            {
+                case '*':
+                {
+                    // "**" matches what "*" does
+                    const char* pAfter = p + 1;
+                    while (pAfter < pEnd && *pAfter == '*')
+                        ++pAfter;
+
+                    // no more characters, or one more within this part of the address
+                    matchFrom (iNode, pAfter, pStart, pEnd, callback);
+                    for (int iChild = firstChild (iNode); iChild >= 0; iChild = nextSibling (iChild))
+                        if (m_nodes[(size_t) iChild].c != '/')
+                            matchFrom (iChild, p, pStart, pEnd, callback);
+                    return;
+                }
+
+                case '?':
+                    for (int iChild = firstChild (iNode); iChild >= 0; iChild = nextSibling (iChild))
+                        if (m_nodes[(size_t) iChild].c != '/')
+                            matchFrom (iChild, p + 1, pStart, pEnd, callback);
+                    return;
+
+                case '[':
+                {
+                    const char* pClose = static_cast<const char*> (std::memchr (p, ']', (size_t) (pEnd - p)));
+                    if (pClose == nullptr)
+                        return;
+                    for (int iChild = firstChild (iNode); iChild >= 0; iChild = nextSibling (iChild))
+                        if (inClass (p + 1, pClose, m_nodes[(size_t) iChild].c))
+                            matchFrom (iChild, pClose + 1, pStart, pEnd, callback);
+                    return;
+                }
+
+                case '{':
+                {
+                    const char* pClose = static_cast<const char*> (std::memchr (p, '}', (size_t) (pEnd - p)));
+                    if (pClose == nullptr)
+                        return;
+                    // each comma separated alternative is a literal
+                    for (const char* pAlt = p + 1; pAlt <= pClose;)
+                    {
+                        const char* pAltEnd = pAlt;
+                        while (pAltEnd < pClose && *pAltEnd != ',')
+                            ++pAltEnd;
+
+                        int iAltNode = iNode;
+                        for (const char* c = pAlt; c < pAltEnd && iAltNode >= 0; ++c)
+                            iAltNode = findChild (iAltNode, *c);
+                        if (iAltNode >= 0)
+                            matchFrom (iAltNode, pClose + 1, pStart, pEnd, callback);
+
+                        pAlt = pAltEnd + 1;
+                    }
+                    return;
+                }
+
+                default:
+                {
+                    const int iChild = findChild (iNode, *p);
+                    if (iChild >= 0)
+                        matchFrom (iChild, p + 1, pStart, pEnd, callback);
+                    return;
+                }
+            }
+        }
+
+        // "[a-z]", "[!0-9]" and plain character lists, between '[' and ']'
+        static bool inClass (const char* p, const char* pEnd, char c)
+        {
+            const bool bNegate = p < pEnd && *p == '!';
+            if (bNegate)
+                ++p;
+
+            bool bMatch = false;
+            for (; p < pEnd; ++p)
+            {
+                if (p + 2 < pEnd && p[1] == '-')
+                {
+                    bMatch = bMatch || (c >= p[0] && c <= p[2]);
+                    p += 2;
+                }
+                else
+                {
+                    bMatch = bMatch || c == *p;
+                }
+            }
+            return bMatch != bNegate;
+        }
+
+        int firstChild (int iNode) const   { return m_nodes[(size_t) iNode].iFirstChild; }
+        int nextSibling (int iNode) const   { return m_nodes[(size_t) iNode].iNextSibling; }
+
+        int findChild (int iNode, char c) const
+        {
+            int iChild = firstChild (iNode);
+            while (iChild >= 0 && m_nodes[(size_t) iChild].c != c)
+                iChild = nextSibling (iChild);
+            return iChild;
+        }
+
+        struct Node
+        {
+            char c = 0;
+            int iFirstChild = -1;
+            int iNextSibling = -1;
+            int iId = -1;
+        };
+
+        std::vector<Node> m_nodes;
+        mutable std::vector<juce::uint64> m_visited;
+    };
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    OscScheduler.cpp
+
+  ==============================================================================
+*/
+
+#include "OscScheduler.h"
+
+namespace
+{
+    // seconds between the NTP epoch (1900) and the Unix epoch (1970)
+    constexpr double kfNtpToUnix = 2208988800.0;
+
+    // the offset follows the clocks over a few hundred blocks, callback jitter averages out
+    constexpr double kfClockSmoothing = 0.01;
+
+    // beyond this the clocks jumped (dropout, suspend, clock change) and the anchor restarts
+    constexpr double kfClockResetSec = 0.05;
+
+    // control gestures are scheduled a few blocks ahead, anything further is a wrong clock and applies now
+    constexpr double kfMaxAheadSec = 1.0;
+}
+
+void OscScheduler::prepare (double sampleRate)
+{
+    m_dSampleRate = sampleRate;
+    m_bHasClock = false;
+    m_iNumPending = 0;
+}
+
+double OscScheduler::timetagToSeconds (juce::uint64 iTimetag)
+{
+    return (double) (iTimetag >> 32) + (double) (iTimetag & 0xffffffffu) / 4294967296.0;
+}
+
+double OscScheduler::getSystemTimeSeconds()
+{
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration<double> (now).count() + kfNtpToUnix;
+}
+
+void OscScheduler::beginBlock (juce::int64 iBlockStart, int iNumSamples)
+{
+    m_iBlockStart = iBlockStart;
+    m_iNumSamples = iNumSamples;
+
+    const double dOffset = getSystemTimeSeconds() - iBlockStart / m_dSampleRate;
+    if (! m_bHasClock || std::abs (dOffset - m_dClockOffset) > kfClockResetSec)
+        m_dClockOffset = dOffset;
+    else
+        m_dClockOffset += kfClockSmoothing * (dOffset - m_dClockOffset);
+    m_bHasClock = true;
+}
+
+void OscScheduler::add (const OscControl::Event& event)
+{
+    juce::int64 iSample = m_iBlockStart;
+    if (event.iTimetag > Osc::kiImmediately)
+    {
+        const double dAhead = timetagToSeconds (event.iTimetag) - m_dClockOffset - m_iBlockStart / m_dSampleRate;
+        if (dAhead > 0.0 && dAhead <= kfMaxAheadSec)
+            iSample = m_iBlockStart + (juce::int64) std::llround (dAhead * m_dSampleRate);
+    }
+
+    if (m_iNumPending < kiMaxPending)
+    {
+        m_pending[m_iNumPending++] = { event, iSample };
+        return;
+    }
+
+    // full: the latest scheduled event gives way, so queued future events never block earlier ones
+    int iLatest = 0;
+    for (int i = 1; i < m_iNumPending; ++i)
+        if (m_pending[i].iSample >= m_pending[iLatest].iSample)
+            iLatest = i;
+
+    ++m_iDropped;
+    if (m_pending[iLatest].iSample <= iSample)
+        return;
+
+    for (int i = iLatest + 1; i < m_iNumPending; ++i)
+        m_pending[i - 1] = m_pending[i];
+    m_pending[m_iNumPending - 1] = { event, iSample };
+}
+
+bool OscScheduler::next (OscControl::Event& event, int& iOffset)
+{
+    const juce::int64 iBlockEnd = m_iBlockStart + m_iNumSamples;
+
+    // few events are ever pending, a scan beats keeping them sorted
+    int iEarliest = -1;
+    for (int i = 0; i < m_iNumPending; ++i)
+        if (m_pending[i].iSample < iBlockEnd
+            && (iEarliest < 0 || m_pending[i].iSample < m_pending[iEarliest].iSample))
+            iEarliest = i;
+
+    if (iEarliest < 0)
+        return false;
+
+    event = m_pending[iEarliest].event;
+    iOffset = (int) juce::jmax ((juce::int64) 0, m_pending[iEarliest].iSample - m_iBlockStart);
+
+    // keep arrival order among the rest, events at the same sample apply in the order they came
+    for (int i = iEarliest + 1; i < m_iNumPending; ++i)
+        m_pending[i - 1] = m_pending[i];
+    --m_iNumPending;
+    return true;
+}
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    OscScheduler.h
+    Places timetagged OSC events at the sample they were meant for.
+
+    OSC bundles carry an NTP timetag. At the top of every block the audio
+    thread anchors its running sample counter to the system clock, and a
+    slowly filtered offset between the two turns timetags into sample
+    positions without the callback jitter. Events are held until the block
+    that contains their sample and come out in time order together with their
+    offset into it. Untagged messages, late bundles and bundles more than a
+    second ahead apply at the start of the next block. When the list is full
+    the latest scheduled event is the one dropped.
+
+    Nothing here knows about a particular plugin, any processor that drains
+    an OscControl can schedule its events through one of these.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscControl.h"
+
+class OscScheduler
+{
+public:
+    // events waiting for a later block
+    static constexpr int kiMaxPending = 256;
+
+    // allocation free, call from prepareToPlay
+    void prepare (double sampleRate);
+
+    // audio thread, at the top of every block before add() and next()
+    void beginBlock (juce::int64 iBlockStart, int iNumSamples);
+
+    // audio thread
+    void add (const OscControl::Event& event);
+
+    // audio thread: the earliest event due in this block and its sample offset into it
+    bool next (OscControl::Event& event, int& iOffset);
+
+    // events dropped because the list was full, any thread
+    int getDropped() const { return m_iDropped; }
+
+    // seconds since 1900, the NTP epoch
+    static double timetagToSeconds (juce::uint64 iTimetag);
+    static double getSystemTimeSeconds();
+
+private:
+    struct Pending
+    {
+        OscControl::Event event;
+        juce::int64 iSample = 0;
+    };
+
+    double m_dSampleRate = 0.0;
+    juce::int64 m_iBlockStart = 0;
+    int m_iNumSamples = 0;
+
+    // system time at sample 0 of the running counter
+    double m_dClockOffset = 0.0;
+    bool m_bHasClock = false;
+
+    Pending m_pending[kiMaxPending];
+    int m_iNumPending = 0;
+    std::atomic<int> m_iDropped { 0 };
+};
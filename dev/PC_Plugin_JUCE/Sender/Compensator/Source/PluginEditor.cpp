@@ -14,28 +14,82 @@ CompensatorAudioProcessorEditor::CompensatorAudioProcessorEditor (CompensatorAud
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
     addAndMakeVisible(&delaySlider);
-    delaySlider.setRange(0.0f, 10.0f, 0.1f);
-    delaySlider.setValue(1.0f);
     delaySlider.setTextValueSuffix(" s");
-    delaySlider.addListener(this);
+    delayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.parameters, "delay", delaySlider);
     
     addAndMakeVisible(delayLabel);
     delayLabel.setText("Delay Time", juce::dontSendNotification);
     delayLabel.attachToComponent(&delaySlider, true);
     
-    if (! connect(9001))
-        showConnectionErrorMessage("Error: could not connect to UDP port 9001.");
+    addAndMakeVisible(&maxDelaySlider);
+    maxDelaySlider.setTextValueSuffix(" s");
+    maxDelayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.parameters, "maxDelay", maxDelaySlider);
     
-    // add the listener to the OSC port
-    addListener(this, "/juce/rotaryknob");
+    addAndMakeVisible(maxDelayLabel);
+    maxDelayLabel.setText("Max Delay", juce::dontSendNotification);
+    maxDelayLabel.attachToComponent(&maxDelaySlider, true);
     
-    setSize (400, 100);
+    addAndMakeVisible(measureButton);
+    measureButton.onClick = [this] { audioProcessor.startLatencyMeasurement(); };
+    
+    addAndMakeVisible(trackButton);
+    trackAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.parameters, "track", trackButton);
+    
+    addAndMakeVisible(pdcButton);
+    pdcAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.parameters, "pdc", pdcButton);
+    
+    addAndMakeVisible(alignButton);
+    alignButton.onClick = [this] { audioProcessor.startAlignment(); };
+    
+    addAndMakeVisible(channelBox);
+    for (int ch = 1; ch <= juce::jmax (1, audioProcessor.getMainBusNumInputChannels()); ++ch)
+        channelBox.addItem("Channel " + juce::String (ch), ch);
+    channelBox.setSelectedId(1, juce::dontSendNotification);
+    channelBox.onChange = [this] { attachChannelDelay(); };
+    
+    addAndMakeVisible(&channelDelaySlider);
+    channelDelaySlider.setTextValueSuffix(" s");
+    attachChannelDelay();
+    
+    // items must exist before the attachment selects one
+    addAndMakeVisible(storageBox);
+    storageBox.addItemList(audioProcessor.parameters.getParameter ("storage")->getAllValueStrings(), 1);
+    storageAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.parameters, "storage", storageBox);
+    
+    addAndMakeVisible(storageLabel);
+    storageLabel.setText("Storage", juce::dontSendNotification);
+    storageLabel.attachToComponent(&storageBox, true);
+    
+    addAndMakeVisible(followButton);
+    followAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment> (audioProcessor.parameters, "follow", followButton);
+    
+    addAndMakeVisible(&followWindowSlider);
+    followWindowSlider.setTextValueSuffix(" s");
+    followWindowAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.parameters, "followWindow", followWindowSlider);
+    
+    // the feed id shown by the receiver instance to follow
+    addAndMakeVisible(followFeedBox);
+    followFeedBox.addItemList(audioProcessor.parameters.getParameter ("followFeed")->getAllValueStrings(), 1);
+    followFeedAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment> (audioProcessor.parameters, "followFeed", followFeedBox);
+    
+    addAndMakeVisible(followFeedLabel);
+    followFeedLabel.setText("Follow Feed", juce::dontSendNotification);
+    followFeedLabel.attachToComponent(&followFeedBox, true);
+    
+    setSize (400, 370);
+    startTimerHz (5);
 }
 
 CompensatorAudioProcessorEditor::~CompensatorAudioProcessorEditor()
 {
 }
 
+void CompensatorAudioProcessorEditor::attachChannelDelay()
+{
+    channelDelayAttachment.reset();
+    channelDelayAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment> (audioProcessor.parameters, "channelDelay" + juce::String (channelBox.getSelectedId()), channelDelaySlider);
+}
+
 //==============================================================================
 void CompensatorAudioProcessorEditor::paint (juce::Graphics& g)
 {
@@ -44,35 +98,113 @@ void CompensatorAudioProcessorEditor::paint (juce::Graphics& g)
 
     g.setColour (juce::Colours::white);
     g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
-}
+    // outcome of the last latency measurement
+    const auto& meter = audioProcessor.getLatencyMeter();
+    juce::String measureText;
+    switch (meter.getState())
+    {
+        case LatencyMeter::State::idle:      measureText = "not measured"; break;
+        case LatencyMeter::State::probing:   measureText = "measuring..."; break;
+        case LatencyMeter::State::analysing: measureText = "analysing..."; break;
+        case LatencyMeter::State::done:
+        case LatencyMeter::State::failed:
+        {
+            const auto result = meter.getResult();
+            measureText = meter.getState() == LatencyMeter::State::done
+                            ? juce::String (result.dLag / meter.getSampleRate() * 1000.0, 2) + " ms"
+                            : juce::String ("no clear echo, is the return routed to the sidechain?");
+            measureText << "  (confidence " << juce::String (result.fConfidence, 2) << ")";
+            break;
+        }
+    }
+    g.setFont (12.0f);
+    g.drawFittedText (measureText, 120, 80, getWidth() - 130, 20, juce::Justification::centredLeft, 1);
 
-void CompensatorAudioProcessorEditor::resized()
-{
-    auto sliderLeft = 120;
-    delaySlider.setBounds(sliderLeft, 20, getWidth() - sliderLeft - 10, 20);
-}
+    // latest live estimate, applied only when confident
+    const auto& tracker = audioProcessor.getLatencyTracker();
+    juce::String trackText = "off";
+    if (tracker.isEnabled())
+    {
+        const auto latest = tracker.getLatest();
+        trackText = latest.fConfidence > 0.0f
+                      ? juce::String (latest.dLag / meter.getSampleRate() * 1000.0, 2) + " ms  (confidence "
+                          + juce::String (latest.fConfidence, 2) + ")"
+                      : juce::String ("waiting for signal on both sides");
+    }
+    g.drawFittedText (trackText, 120, 110, getWidth() - 130, 20, juce::Justification::centredLeft, 1);
 
+    // latency the host compensates, put this instance on the return track to use it
+    const juce::String pdcText = audioProcessor.isPdcEnabled()
+                                   ? "host delays other tracks by " + juce::String (audioProcessor.getReportedLatency()) + " samples"
+                                   : juce::String ("off, delaying here");
+    g.drawFittedText (pdcText, 120, 140, getWidth() - 130, 20, juce::Justification::centredLeft, 1);
 
-void CompensatorAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
-{
-    if (slider == &delaySlider)
+    // skew of every channel against channel 1 from the last alignment
+    const auto& aligner = audioProcessor.getChannelAligner();
+    juce::String alignText;
+    switch (aligner.getState())
     {
-        audioProcessor.fLenSec = delaySlider.getValue();
+        case ChannelAligner::State::idle:      alignText = aligner.getNumChannels() > 1 ? "not aligned" : "needs two or more channels"; break;
+        case ChannelAligner::State::capturing: alignText = "listening..."; break;
+        case ChannelAligner::State::analysing: alignText = "analysing..."; break;
+        case ChannelAligner::State::done:
+            for (int ch = 1; ch < aligner.getNumChannels(); ++ch)
+            {
+                const auto result = aligner.getResult (ch);
+                alignText << (ch + 1) << ": ";
+                if (result.fConfidence >= ChannelAligner::kfMinConfidence)
+                    alignText << juce::String (result.dLag / meter.getSampleRate() * 1000.0, 1) << " ms  ";
+                else
+                    alignText << "?  ";
+            }
+            break;
     }
-}
+    g.drawFittedText (alignText, 120, 170, getWidth() - 130, 20, juce::Justification::centredLeft, 1);
 
+    // remote control, received by the processor whether or not this window is open
+    const auto& osc = audioProcessor.getOscControl();
+    juce::String oscText = "OSC: ";
+    if (! osc.isStarted())
+        oscText << "opens port " << OscControl::kiPort << " when playback starts";
+    else if (! osc.isListening())
+        oscText << "port " << OscControl::kiPort << " busy, retrying";
+    else
+        oscText << "port " << OscControl::kiPort << ", knob to audio "
+                << juce::String (audioProcessor.getOscLatencyMs(), 2) << " ms (max "
+                << juce::String (audioProcessor.getOscMaxLatencyMs(), 2) << " ms)";
+    if (osc.isListening() && audioProcessor.isFollowing())
+        oscText << ", feed " << audioProcessor.getFollowedFeed() << " path " << juce::String (audioProcessor.getFollowedLatency() * 1000.0f, 1) << " ms";
 
-void CompensatorAudioProcessorEditor::oscMessageReceived (const juce::OSCMessage& message)
+    // memory held for the delay ring of this instance
+    const auto kiloBytes = (double) audioProcessor.getMemoryFootprint() / 1024.0;
+    auto footer = getLocalBounds().removeFromBottom (50);
+    g.drawFittedText (oscText, footer.removeFromTop (20), juce::Justification::centred, 1);
+    g.drawFittedText ("delay memory: " + juce::String (kiloBytes, 1) + " KB",
+                      footer, juce::Justification::centred, 1);
+}
+
+void CompensatorAudioProcessorEditor::resized()
 {
-    if (message.size() == 1 && message[0].isFloat32())
-    {
-        // any osc API import ranges from 0 ~ 1
-        delaySlider.setValue(juce::jlimit(0.0f, 10.0f, message[0].getFloat32()*10));
-    }
+    auto sliderLeft = 120;
+    delaySlider.setBounds(sliderLeft, 20, getWidth() - sliderLeft - 10, 20);
+    maxDelaySlider.setBounds(sliderLeft, 50, getWidth() - sliderLeft - 10, 20);
+    measureButton.setBounds(10, 80, sliderLeft - 20, 20);
+    trackButton.setBounds(10, 110, sliderLeft - 20, 20);
+    pdcButton.setBounds(10, 140, sliderLeft - 20, 20);
+    alignButton.setBounds(10, 170, sliderLeft - 20, 20);
+    channelBox.setBounds(10, 200, sliderLeft - 20, 20);
+    channelDelaySlider.setBounds(sliderLeft, 200, getWidth() - sliderLeft - 10, 20);
+    storageBox.setBounds(sliderLeft, 230, 140, 20);
+    followButton.setBounds(10, 260, sliderLeft - 20, 20);
+    followWindowSlider.setBounds(sliderLeft, 260, getWidth() - sliderLeft - 10, 20);
+    followFeedBox.setBounds(sliderLeft, 290, 140, 20);
 }
 
-void CompensatorAudioProcessorEditor::showConnectionErrorMessage (const juce::String& messageText)
+void CompensatorAudioProcessorEditor::timerCallback()
 {
-    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Connection error", messageText, "OK");
+    // the probe would go out on the return track in PDC mode
+    measureButton.setEnabled (! audioProcessor.isPdcEnabled());
+    alignButton.setEnabled (audioProcessor.getChannelAligner().getNumChannels() > 1);
+    repaint();
 }
+
@@ -15,9 +15,7 @@
 /**
 */
 class CompensatorAudioProcessorEditor  : public juce::AudioProcessorEditor,
-                                        private juce::Slider::Listener,
-                                        private juce::OSCReceiver,
-                                        private juce::OSCReceiver::ListenerWithOSCAddress<juce::OSCReceiver::MessageLoopCallback>
+                                        private juce::Timer
 {
 public:
     CompensatorAudioProcessorEditor (CompensatorAudioProcessor&);
@@ -34,12 +32,41 @@ private:
     
     juce::Slider delaySlider;
     juce::Label delayLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> delayAttachment;
     
-    void sliderValueChanged (juce::Slider* slider) override;
+    juce::Slider maxDelaySlider;
+    juce::Label maxDelayLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> maxDelayAttachment;
     
-    void oscMessageReceived (const juce::OSCMessage& message) override;
+    juce::TextButton measureButton { "Measure" };
+    juce::ToggleButton trackButton { "Track" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> trackAttachment;
     
-    void showConnectionErrorMessage (const juce::String& messageText);
+    juce::ToggleButton pdcButton { "PDC" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> pdcAttachment;
+    
+    // one slider for the per channel delays, the box picks which one it edits
+    juce::TextButton alignButton { "Align" };
+    juce::ComboBox channelBox;
+    juce::Slider channelDelaySlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> channelDelayAttachment;
+    
+    void attachChannelDelay();
+    
+    juce::ComboBox storageBox;
+    juce::Label storageLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> storageAttachment;
+    
+    // path delay reports from the transport move the delay within the window
+    juce::ToggleButton followButton { "Follow" };
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> followAttachment;
+    juce::Slider followWindowSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> followWindowAttachment;
+    juce::ComboBox followFeedBox;
+    juce::Label followFeedLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> followFeedAttachment;
+    
+    void timerCallback() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompensatorAudioProcessorEditor)
 };
@@ -16,18 +16,133 @@ CompensatorAudioProcessor::CompensatorAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Return", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
-                       )
+                       ),
+#else
+     :
 #endif
+       parameters (*this, nullptr, "Compensator", createParameterLayout())
 {
-    m_fLenSec = 1.0;
-    m_fBuffLenSec = m_fLenSec*10;
+    m_pfDelayTime = parameters.getRawParameterValue ("delay");
+    m_pfMaxDelayTime = parameters.getRawParameterValue ("maxDelay");
+    m_pfPdc = parameters.getRawParameterValue ("pdc");
+    m_pfStorage = parameters.getRawParameterValue ("storage");
+    m_pfFollow = parameters.getRawParameterValue ("follow");
+    m_pfFollowWindow = parameters.getRawParameterValue ("followWindow");
+    m_pfFollowFeed = parameters.getRawParameterValue ("followFeed");
+    m_pDelayParameter = parameters.getParameter ("delay");
+    for (int ch = 0; ch < kiMaxChannels; ++ch)
+        m_pfChannelDelay[ch] = parameters.getRawParameterValue ("channelDelay" + juce::String (ch + 1));
+    parameters.addParameterListener ("delay", this);
+    parameters.addParameterListener ("maxDelay", this);
+    parameters.addParameterListener ("storage", this);
+    parameters.addParameterListener ("track", this);
+    parameters.addParameterListener ("analysisRate", this);
+
+    m_latencyTracker.setEnabled (*parameters.getRawParameterValue ("track") > 0.5f);
+    m_latencyTracker.setAnalysisRate (*parameters.getRawParameterValue ("analysisRate"));
+
+    m_channelAligner.onFinished = [this]
+    {
+        m_bAlignmentPending = true;
+        triggerAsyncUpdate();
+    };
+    m_latencyMeter.onFinished = [this]
+    {
+        m_bMeasurementPending = true;
+        triggerAsyncUpdate();
+    };
+    m_latencyTracker.onStableEstimate = [this] (double dLag)
+    {
+        m_dTrackedLag = dLag;
+        m_bTrackedPending = true;
+        triggerAsyncUpdate();
+    };
+    // what the Electron console sends as "/juce/<target>"
+    m_iOscDelaySlot = m_oscControl.addSlot ("/juce/rotaryknob", OscControl::SlotType::normalised);
+    m_pOscParameters[m_iOscDelaySlot] = m_pDelayParameter;
+    m_pOscParameters[m_oscControl.addSlot ("/juce/track", OscControl::SlotType::toggle)] = parameters.getParameter ("track");
+    m_pOscParameters[m_oscControl.addSlot ("/juce/pdc", OscControl::SlotType::toggle)] = parameters.getParameter ("pdc");
+    m_iOscMeasureSlot = m_oscControl.addSlot ("/juce/measure", OscControl::SlotType::trigger);
+    m_iOscAlignSlot = m_oscControl.addSlot ("/juce/align", OscControl::SlotType::trigger);
+    for (int ch = 0; ch < kiMaxChannels; ++ch)
+    {
+        const auto address = "/juce/delay/" + juce::String (ch + 1);
+        m_pOscParameters[m_oscControl.addSlot (address.toRawUTF8(), OscControl::SlotType::normalised)]
+            = parameters.getParameter ("channelDelay" + juce::String (ch + 1));
+    }
+    // published by every receiver plugin while it plays its returned stream, under its feed id
+    for (int iFeed = 1; iFeed <= kiMaxFeeds; ++iFeed)
+    {
+        const auto address = "/vibeio/latency/" + juce::String (iFeed);
+        const int iSlot = m_oscControl.addSlot (address.toRawUTF8(), OscControl::SlotType::value);
+        if (iFeed == 1)
+            m_iOscLatencySlot = iSlot;
+    }
+    m_oscControl.onValue = [this]
+    {
+        m_bOscPending = true;
+        triggerAsyncUpdate();
+    };
+    
+    startTimerHz (10);
 }
 
 CompensatorAudioProcessor::~CompensatorAudioProcessor()
 {
+    parameters.removeParameterListener ("delay", this);
+    parameters.removeParameterListener ("maxDelay", this);
+    parameters.removeParameterListener ("storage", this);
+    parameters.removeParameterListener ("track", this);
+    parameters.removeParameterListener ("analysisRate", this);
+    m_latencyMeter.onFinished = nullptr;
+    m_latencyTracker.onStableEstimate = nullptr;
+    m_channelAligner.onFinished = nullptr;
+    m_oscControl.stop();
+    cancelPendingUpdate();
+    stopTimer();
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout CompensatorAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    // continuous, measured and tracked latencies are finer than any step
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "delay", 1 }, "Delay Time",
+                                                             juce::NormalisableRange<float> (0.0f, 10.0f), 1.0f,
+                                                             juce::AudioParameterFloatAttributes().withLabel ("s")));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "maxDelay", 1 }, "Max Delay Time",
+                                                             juce::NormalisableRange<float> (0.01f, 10.0f, 0.001f), 1.0f,
+                                                             juce::AudioParameterFloatAttributes().withLabel ("s")));
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "track", 1 }, "Track Latency", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "analysisRate", 1 }, "Analysis Rate",
+                                                             juce::NormalisableRange<float> (0.1f, 4.0f, 0.1f), 1.0f,
+                                                             juce::AudioParameterFloatAttributes().withLabel ("Hz")));
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "pdc", 1 }, "Host Delay Compensation", false));
+    
+    // compact rings for long multichannel delays, in DelayLine::Format order
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "storage", 1 }, "Delay Storage",
+                                                              juce::StringArray { "32-bit float", "24-bit", "16-bit" }, 0));
+    
+    // how far path delay reports may move the delay on their own
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { "follow", 1 }, "Follow Transport Latency", false));
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "followWindow", 1 }, "Follow Window",
+                                                             juce::NormalisableRange<float> (0.0f, 1.0f, 0.001f), 0.1f,
+                                                             juce::AudioParameterFloatAttributes().withLabel ("s")));
+    juce::StringArray feeds;
+    for (int iFeed = 1; iFeed <= kiMaxFeeds; ++iFeed)
+        feeds.add (juce::String (iFeed));
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { "followFeed", 1 }, "Follow Feed", feeds, 0));
+    
+    // on top of "delay", so each returned stem or microphone can be lined up
+    for (int ch = 1; ch <= kiMaxChannels; ++ch)
+        layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { "channelDelay" + juce::String (ch), 1 },
+                                                                 "Channel " + juce::String (ch) + " Delay",
+                                                                 juce::NormalisableRange<float> (0.0f, 1.0f), 0.0f,
+                                                                 juce::AudioParameterFloatAttributes().withLabel ("s")));
+    return layout;
 }
 
 //==============================================================================
@@ -65,7 +180,8 @@ bool CompensatorAudioProcessor::isMidiEffect() const
 
 double CompensatorAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // the delayed input keeps playing this long after it stops
+    return m_iSampleRate > 0 ? getDelayInSamples() / m_iSampleRate : 0.0;
 }
 
 int CompensatorAudioProcessor::getNumPrograms()
@@ -96,18 +212,57 @@ void CompensatorAudioProcessor::changeProgramName (int index, const juce::String
 void CompensatorAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     m_iSampleRate = (int) sampleRate;
+    m_iNumChannels = getMainBusNumInputChannels();
+    m_iMaxBlockSize = samplesPerBlock;
+    
+    // threads and the OSC socket wait for the first prepareToPlay, so plugin
+    // scans and sessions with many instances do not open them all up front.
+    // Both calls do nothing once running
+    m_resizer.start();
+    m_oscControl.start();
+    
+    // nothing is in flight while the audio thread is stopped
+    m_resizer.reset();
+    
+    // only reallocate when the ring would actually change size, the ring is rounded up to a power of two
+    const int iMaxDelay = getMaxDelayInSamples();
+    if (m_delayLine == nullptr || m_delayLine->needsRealloc (m_iNumChannels, iMaxDelay, samplesPerBlock, getStorageFormat()))
+    {
+        m_delayLine = std::make_unique<DelayLine>();
+        m_delayLine->prepare (m_iNumChannels, iMaxDelay, samplesPerBlock, getStorageFormat());
+        m_fDelayRamp.allocate ((size_t) samplesPerBlock, true);
+        m_fChannelRamp.allocate ((size_t) samplesPerBlock, true);
+    }
+    else
+    {
+        m_delayLine->clear();
+    }
+    m_resizer.setSource (m_delayLine.get());
+    m_iSubBlockChannels = juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels());
+    m_pfSubBlockChannels.allocate ((size_t) m_iSubBlockChannels, true);
+    m_iLineMaxDelay = m_delayLine->getMaxDelay();
+    m_iLineBytes = m_delayLine->getMemoryFootprint();
     
-    // compute the total buffer length and create it
-    m_iBuffLenSample = (int) (m_fBuffLenSec * m_iSampleRate);
-    m_fDelayBuffer = juce::AudioBuffer<float>(getTotalNumInputChannels(), (int) m_iBuffLenSample);
-    if (m_iBuffLenSample < 1)
-        m_iBuffLenSample = 1;
-    m_fDelayBuffer.clear();
+    m_smoothedDelay.reset (sampleRate, kfRampSec);
+    for (int ch = 0; ch < kiMaxChannels; ++ch)
+    {
+        m_smoothedChannelDelay[ch].reset (sampleRate, kfRampSec);
+        m_smoothedChannelDelay[ch].setCurrentAndTargetValue (*m_pfChannelDelay[ch] * (float) sampleRate);
+    }
+    
+    m_oscScheduler.prepare (sampleRate);
+    m_channelAligner.prepare (sampleRate, m_iNumChannels);
+    m_latencyMeter.prepare (sampleRate);
+    m_latencyTracker.prepare (sampleRate, (int) (LatencyMeter::kfMaxLatencySec * sampleRate));
     
-    // compute the delay length and set read start position
-    m_iLenSample = (int) (m_fLenSec * m_iSampleRate);
-    m_iReadIdx = (int) ((m_iWriteIdx - m_iLenSample + m_iBuffLenSample) % m_iBuffLenSample);
+    // the host expects to restart here anyway, so report at once without settling
+    m_iReportedLatency = 0;
+    m_iReportedLatency = getLatencyToReport();
+    m_iPendingLatency = -1;
+    setLatencySamples (m_iReportedLatency);
     
+    // the residual must be in place before the first block
+    m_smoothedDelay.setCurrentAndTargetValue (getDelayInSamples());
 }
 
 void CompensatorAudioProcessor::releaseResources()
@@ -123,18 +278,22 @@ bool CompensatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // anything from mono to 32 returned stems or microphones, each delayed on its own
+    const int numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > kiMaxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // the return sidechain is only needed to measure latency
+    const auto returnSet = layouts.getChannelSet (true, 1);
+    if (! returnSet.isDisabled()
+     && returnSet != juce::AudioChannelSet::mono()
+     && returnSet != juce::AudioChannelSet::stereo())
+        return false;
    #endif
 
     return true;
@@ -142,55 +301,413 @@ bool CompensatorAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 }
 #endif
 
-void CompensatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+int CompensatorAudioProcessor::getMaxDelayInSamples() const
+{
+    return (int) std::ceil (*m_pfMaxDelayTime * m_iSampleRate);
+}
+
+float CompensatorAudioProcessor::getDelayInSamples() const
+{
+    // fractions of a sample are kept, so a measured latency aligns without comb filtering
+    const int iLimit = juce::jmin (getMaxDelayInSamples(), m_iLineMaxDelay.load());
+    float fDelay = (m_bOscOverride ? m_fOscDelayTime.load() : m_pfDelayTime->load()) * m_iSampleRate;
+    
+    // with PDC the host advances this track by the reported latency, so only
+    // what it overshoots by is delayed here
+    if (isPdcEnabled())
+        fDelay = (float) m_iReportedLatency - fDelay;
+    
+    return juce::jlimit (0.0f, (float) iLimit, fDelay);
+}
+
+int CompensatorAudioProcessor::getLatencyToReport() const
 {
+    const double dDelay = *m_pfDelayTime * m_iSampleRate;
+    if (! isPdcEnabled() || dDelay <= 0.0)
+        return 0;
     
+    // keep the current report while the residual still fits the headroom
+    const int iReported = m_iReportedLatency;
+    if (iReported > 0 && iReported >= dDelay && iReported - dDelay <= kiPdcHeadroom)
+        return iReported;
     
-    // if delay is too low, deactivate the delay fx
-    if (fLenSec >= 0.001)
+    return (int) std::ceil (dDelay) + kiPdcHeadroom / 2;
+}
+
+void CompensatorAudioProcessor::timerCallback()
+{
+    if (m_bOscDelayApplied.exchange (false))
+        m_pDelayParameter->setValueNotifyingHost (m_fOscDelayValue);
+    
+    const int iLatency = getLatencyToReport();
+    if (iLatency == m_iReportedLatency)
+    {
+        m_iPendingLatency = -1;
+        return;
+    }
+    
+    // switching PDC on or off applies at once, a moving delay only once it has
+    // held still, so dragging the slider or a settling tracker is one change
+    const auto now = juce::Time::getMillisecondCounter();
+    if (iLatency != 0 && m_iReportedLatency != 0)
+    {
+        if (iLatency != m_iPendingLatency)
+        {
+            m_iPendingLatency = iLatency;
+            m_iPendingSinceMs = now;
+            return;
+        }
+        if (now - m_iPendingSinceMs < kiPdcSettleMs)
+            return;
+    }
+    
+    m_iPendingLatency = -1;
+    m_iReportedLatency = iLatency;
+    setLatencySamples (iLatency);
+}
+
+void CompensatorAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
+{
+    if (parameterID == "track")
+    {
+        m_latencyTracker.setEnabled (newValue > 0.5f);
+    }
+    else if (parameterID == "analysisRate")
+    {
+        m_latencyTracker.setAnalysisRate (newValue);
+    }
+    else if (parameterID == "delay")
+    {
+        // may run on the audio thread, the host is told about the new maximum from the message thread
+        if (newValue > *m_pfMaxDelayTime)
+        {
+            m_bMaxDelayPending = true;
+            triggerAsyncUpdate();
+        }
+    }
+    else if (parameterID == "maxDelay")
+    {
+        // may run on the audio thread, so only post a request. Lowering the
+        // maximum keeps the ring until the next prepareToPlay
+        const int iMaxDelay = (int) std::ceil (newValue * m_iSampleRate);
+        if (m_iSampleRate > 0 && iMaxDelay > m_iLineMaxDelay)
+            m_resizer.request (m_iNumChannels, iMaxDelay, m_iMaxBlockSize, getStorageFormat());
+    }
+    else if (parameterID == "storage")
+    {
+        // same length in the new format, the resizer converts the history while copying it
+        if (m_iSampleRate > 0)
+            m_resizer.request (m_iNumChannels, juce::jmax (getMaxDelayInSamples(), m_iLineMaxDelay.load()),
+                               m_iMaxBlockSize, (DelayLine::Format) juce::roundToInt (newValue));
+    }
+}
+
+void CompensatorAudioProcessor::adoptResizedDelayLine()
+{
+    DelayLine* pLine = m_resizer.collect();
+    if (pLine == nullptr)
+        return;
+
+    // a line requested before the last prepareToPlay may not fit any more
+    const bool bNewFormat = pLine->getFormat() != m_delayLine->getFormat();
+    if (pLine->getNumChannels() != m_iNumChannels
+        || pLine->getMaxDelay() < m_delayLine->getMaxDelay()
+        || (pLine->getMaxDelay() == m_delayLine->getMaxDelay() && ! bNewFormat))
     {
-        const int numInChannels = getTotalNumOutputChannels();
-        const int numSamples = buffer.getNumSamples();
+        m_resizer.retire (pLine);
+        return;
+    }
 
-//      m_fLenSec = *m_pfDelayTime;
-        m_fLenSec = fLenSec;
-        m_iLenSample = (int) (m_fLenSec * m_iSampleRate);
-        m_iReadIdx = (int) ((m_iWriteIdx - m_iLenSample + m_iBuffLenSample) % m_iBuffLenSample);
+    // the resizer copied the history up to pLine->getNumWritten(), only the
+    // blocks written since are left. When the audio ran on much longer, e.g.
+    // while the host stalled, the line is copied again instead
+    const juce::int64 iWritten = m_delayLine->getNumWritten();
+    const juce::int64 iMissing = iWritten - pLine->getNumWritten();
+    if (iMissing < 0 || iMissing > (juce::int64) kiMaxCatchUpBlocks * m_iMaxBlockSize)
+    {
+        m_resizer.request (pLine->getNumChannels(), pLine->getMaxDelay(), m_iMaxBlockSize, pLine->getFormat());
+        m_resizer.retire (pLine);
+        return;
+    }
+    pLine->copyHistoryFrom (*m_delayLine, pLine->getNumWritten(), iWritten);
+    pLine->continueFrom (iWritten);
+
+    m_resizer.retire (m_delayLine.release());
+    m_delayLine.reset (pLine);
+    m_resizer.setSource (pLine);
+    m_iLineMaxDelay = m_delayLine->getMaxDelay();
+    m_iLineBytes = m_delayLine->getMemoryFootprint();
+}
 
-        int rIdx, wIdx;
+size_t CompensatorAudioProcessor::getMemoryFootprint() const
+{
+    return m_iLineBytes + m_resizer.getPendingFootprint() + 2 * (size_t) m_iMaxBlockSize * sizeof (float);
+}
 
-        for (int channel = 0; channel < numInChannels; ++channel)
+void CompensatorAudioProcessor::applyOscEvents()
+{
+    // host automation or the synced parameter take over again once they move
+    if (m_bOscOverride && *m_pfDelayTime != m_fDelayTimeAtOsc)
+        m_bOscOverride = false;
+
+    // the next report starts from wherever the delay is by then, another
+    // feed measures another path and has to be anchored afresh
+    if (! isFollowing() || getFollowedFeed() != m_iFollowAnchorFeed)
+        m_bFollowAnchored = false;
+
+    OscControl::Event event;
+    while (m_oscControl.pop (event))
+    {
+        // switches and triggers only need the message thread
+        if (event.iSlot != m_iOscDelaySlot
+            && (event.iSlot != m_iOscLatencySlot + getFollowedFeed() - 1 || ! isFollowing()))
+            continue;
+
+        const double dLatencyMs = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks()
+                                                                              - event.iReceivedTicks) * 1000.0;
+        m_dOscLatencyMs = dLatencyMs;
+        if (dLatencyMs > m_dOscMaxLatencyMs)
+            m_dOscMaxLatencyMs = dLatencyMs;
+
+        m_oscScheduler.add (event);
+    }
+}
+
+void CompensatorAudioProcessor::applyOscDelay (float fValue)
+{
+    m_fOscDelayTime = m_pDelayParameter->convertFrom0to1 (fValue);
+    m_fDelayTimeAtOsc = *m_pfDelayTime;
+    m_bOscOverride = true;
+    m_smoothedDelay.setTargetValue (getDelayInSamples());
+
+    // the timer shows the value to the host once it is actually playing
+    m_fOscDelayValue = fValue;
+    m_bOscDelayApplied = true;
+}
+
+void CompensatorAudioProcessor::applyLatencyReport (float fReportSec)
+{
+    m_fFollowReport = fReportSec;
+    if (! isFollowing())
+        return;
+
+    // a delay set by hand, measured or tracked since the last report becomes the new anchor
+    const float fCurrent = m_bOscOverride ? m_fOscDelayTime.load() : m_pfDelayTime->load();
+    if (! m_bFollowAnchored || std::abs (fCurrent - m_fFollowLastSet) * m_iSampleRate > 1.0f)
+    {
+        m_bFollowAnchored = true;
+        m_iFollowAnchorFeed = getFollowedFeed();
+        m_fFollowAnchorDelay = fCurrent;
+        m_fFollowAnchorReport = fReportSec;
+        m_fFollowLastSet = fCurrent;
+        return;
+    }
+
+    // the return arrives as much later as the path grew, so the delay grows with it
+    const float fWindow = *m_pfFollowWindow;
+    const float fFollowed = juce::jlimit (juce::jmax (0.0f, m_fFollowAnchorDelay - fWindow), m_fFollowAnchorDelay + fWindow,
+                                          m_fFollowAnchorDelay + fReportSec - m_fFollowAnchorReport);
+    const float fTarget = juce::jmin (m_pfMaxDelayTime->load(), fFollowed);
+
+    // reports repeat while nothing changes, those must not restart the glide
+    if (std::abs (fTarget - fCurrent) * m_iSampleRate < 0.5f)
+        return;
+
+    applyOscDelay (m_pDelayParameter->convertTo0to1 (fTarget));
+    m_fFollowLastSet = m_fOscDelayTime;
+}
+
+void CompensatorAudioProcessor::handleAsyncUpdate()
+{
+    // the audio already follows the OSC delay, this shows it to the host and the editor
+    if (m_bOscPending.exchange (false))
+    {
+        for (int iSlot = 0; iSlot < m_oscControl.getNumSlots(); ++iSlot)
         {
-            float* channelData = buffer.getWritePointer(channel);
-            float* delayData = m_fDelayBuffer.getWritePointer(channel);
+            // the delay is synced by the timer once the audio thread applied it at its timetag,
+            // path delay reports only ever reach it that way
+            if (! m_oscControl.fetchChanged (iSlot) || iSlot == m_iOscDelaySlot || isLatencySlot (iSlot))
+                continue;
+            
+            if (auto* pParameter = m_pOscParameters[iSlot])
+                pParameter->setValueNotifyingHost (m_oscControl.getLatestValue (iSlot));
+            else if (iSlot == m_iOscMeasureSlot)
+                startLatencyMeasurement();
+            else if (iSlot == m_iOscAlignSlot)
+                startAlignment();
+        }
+    }
 
-            rIdx = m_iReadIdx;
-            wIdx = m_iWriteIdx;
-            float inData;
-            float outData;
+    if (m_bAlignmentPending.exchange (false))
+        applyAlignment();
 
-            for (int i = 0; i < numSamples; ++i)
-            {
-                inData = channelData[i];
-                outData = delayData[rIdx];
+    // a delay typed, automated or sent past the maximum grows the ring instead of being clamped
+    if (m_bMaxDelayPending.exchange (false) && *m_pfDelayTime > *m_pfMaxDelayTime)
+    {
+        // "maxDelay" moves in 1 ms steps, rounding down would still clamp
+        auto* pMaxDelay = parameters.getParameter ("maxDelay");
+        pMaxDelay->setValueNotifyingHost (pMaxDelay->convertTo0to1 (std::ceil (*m_pfDelayTime * 1000.0f) / 1000.0f));
+    }
 
-                delayData[wIdx] = inData;
+    if (m_bMeasurementPending.exchange (false) && m_latencyMeter.getState() == LatencyMeter::State::done)
+        applyLatency (m_latencyMeter.getResult().dLag);
 
-                rIdx++;
-                if (rIdx >= m_iBuffLenSample)
-                    rIdx = 0;
-                wIdx++;
-                if (wIdx >= m_iBuffLenSample)
-                    wIdx = 0;
+    // tracking only retargets when the estimate moved by more than half a sample
+    if (m_bTrackedPending.exchange (false)
+        && std::abs (m_dTrackedLag - *m_pfDelayTime * m_iSampleRate) > 0.5)
+        applyLatency (m_dTrackedLag);
+}
+
+void CompensatorAudioProcessor::applyLatency (double dLatencySamples)
+{
+    if (m_iSampleRate <= 0)
+        return;
+
+    const double dLatencySec = dLatencySamples / m_iSampleRate;
+
+    // make room for the measured delay first, the delay then glides to it
+    auto* pMaxDelay = parameters.getParameter ("maxDelay");
+    if (dLatencySec > *m_pfMaxDelayTime)
+        pMaxDelay->setValueNotifyingHost (pMaxDelay->convertTo0to1 ((float) dLatencySec));
+
+    m_pDelayParameter->setValueNotifyingHost (m_pDelayParameter->convertTo0to1 ((float) dLatencySec));
+}
+
+void CompensatorAudioProcessor::applyAlignment()
+{
+    if (m_iSampleRate <= 0)
+        return;
 
-                channelData[i] = outData;
-//                outStream.writeFloat(outData);
+    // the latest confident channel gets no extra delay, the others wait for it.
+    // Channels without a clear peak (silent, unrelated) keep what they had
+    double dLatest = 0.0;
+    for (int ch = 0; ch < m_channelAligner.getNumChannels(); ++ch)
+    {
+        const auto result = m_channelAligner.getResult (ch);
+        if (result.fConfidence >= ChannelAligner::kfMinConfidence)
+            dLatest = juce::jmax (dLatest, result.dLag);
+    }
+
+    float fLongest = 0.0f;
+    for (int ch = 0; ch < m_channelAligner.getNumChannels(); ++ch)
+    {
+        const auto result = m_channelAligner.getResult (ch);
+        if (result.fConfidence < ChannelAligner::kfMinConfidence)
+            continue;
+
+        const float fDelaySec = (float) ((dLatest - result.dLag) / m_iSampleRate);
+        auto* pParameter = parameters.getParameter ("channelDelay" + juce::String (ch + 1));
+        pParameter->setValueNotifyingHost (pParameter->convertTo0to1 (fDelaySec));
+        fLongest = juce::jmax (fLongest, fDelaySec);
+    }
+
+    // make room for the longest channel on top of the common delay
+    auto* pMaxDelay = parameters.getParameter ("maxDelay");
+    if (*m_pfDelayTime + fLongest > *m_pfMaxDelayTime)
+        pMaxDelay->setValueNotifyingHost (pMaxDelay->convertTo0to1 (*m_pfDelayTime + fLongest));
+}
+
+void CompensatorAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // the ramps and the delay line scratch hold m_iMaxBlockSize samples, and the
+    // ring one block on top of maxDelay. A host going past its prepareToPlay
+    // hint is served in pieces of that size
+    const int numSamples = buffer.getNumSamples();
+    float* const* channels = buffer.getArrayOfWritePointers();
+    if (numSamples <= m_iMaxBlockSize)
+    {
+        processSubBlock (channels, numSamples);
+        return;
+    }
+
+    const int numChannels = buffer.getNumChannels();
+    jassert (numChannels <= m_iSubBlockChannels);
+    for (int iStart = 0; iStart < numSamples; iStart += m_iMaxBlockSize)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            m_pfSubBlockChannels[ch] = channels[ch] + iStart;
+        processSubBlock (m_pfSubBlockChannels, juce::jmin (m_iMaxBlockSize, numSamples - iStart));
+    }
+}
+
+void CompensatorAudioProcessor::processSubBlock (float* const* channels, int numSamples)
+{
+    const int numInChannels = getMainBusNumOutputChannels();
+
+    adoptResizedDelayLine();
+    m_oscScheduler.beginBlock (m_iSamplePosition, numSamples);
+    m_iSamplePosition += numSamples;
+    applyOscEvents();
+    m_smoothedDelay.setTargetValue (getDelayInSamples());
+
+    // what we send is the input before it is delayed, the probe would only confuse the tracker.
+    // In PDC mode the input is the return and the sidechain carries what was sent
+    const float* const* returnChannels = channels + getChannelIndexInProcessBlockBuffer (true, 1, 0);
+    const int numReturnChannels = getChannelCountOfBus (true, 1);
+    if (isPdcEnabled())
+        m_latencyTracker.push (returnChannels, numReturnChannels, channels, numInChannels, numSamples);
+    else if (m_latencyMeter.getState() != LatencyMeter::State::probing)
+        m_latencyTracker.push (channels, numInChannels, returnChannels, numReturnChannels, numSamples);
+
+    // one ramp for the block, shared by all channels. Scheduled OSC moves and
+    // path delay reports retarget it at their exact sample
+    jassert (numSamples <= m_iMaxBlockSize);
+    OscControl::Event event;
+    int iEventOffset = 0;
+    bool bHasEvent = m_oscScheduler.next (event, iEventOffset);
+    const bool bGliding = bHasEvent || m_smoothedDelay.isSmoothing();
+    if (bGliding)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            while (bHasEvent && iEventOffset <= i)
+            {
+                if (isLatencySlot (event.iSlot))
+                    applyLatencyReport (event.fValue);
+                else
+                    applyOscDelay (event.fValue);
+                bHasEvent = m_oscScheduler.next (event, iEventOffset);
             }
+            m_fDelayRamp[i] = m_smoothedDelay.getNextValue();
         }
+    }
+
+    // the input before it is delayed
+    m_channelAligner.process (channels, numInChannels, numSamples);
 
-        m_iReadIdx = rIdx;
-        m_iWriteIdx = wIdx;
+    // channels stay planar: with a delay of their own, each one reads a
+    // different stretch of the ring, which one contiguous copy per channel
+    // serves better than gathering interleaved frames
+    const float fLimit = (float) juce::jmin (getMaxDelayInSamples(), m_iLineMaxDelay.load());
+    for (int channel = 0; channel < numInChannels; ++channel)
+    {
+        float* channelData = channels[channel];
+        auto& smoothedChannelDelay = m_smoothedChannelDelay[channel];
+        smoothedChannelDelay.setTargetValue (juce::jlimit (0.0f, fLimit, *m_pfChannelDelay[channel] * m_iSampleRate));
+
+        // write first so a zero delay passes the input straight through
+        m_delayLine->write (channel, channelData, numSamples);
+
+        if (bGliding || smoothedChannelDelay.isSmoothing())
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float fCommon = bGliding ? m_fDelayRamp[i] : m_smoothedDelay.getCurrentValue();
+                m_fChannelRamp[i] = juce::jmin (fLimit, fCommon + smoothedChannelDelay.getNextValue());
+            }
+            m_delayLine->readInterpolated (channel, channelData, numSamples, m_fChannelRamp);
+        }
+        else
+        {
+            const float fDelay = m_smoothedDelay.getCurrentValue() + smoothedChannelDelay.getCurrentValue();
+            m_delayLine->readFractional (channel, channelData, numSamples, juce::jmin (fLimit, fDelay));
+        }
     }
+
+    m_delayLine->advance (numSamples);
+
+    // while measuring, the probe replaces what goes out
+    m_latencyMeter.process (channels, numInChannels, returnChannels, numReturnChannels, numSamples);
 }
 
 //==============================================================================
@@ -207,15 +724,15 @@ juce::AudioProcessorEditor* CompensatorAudioProcessor::createEditor()
 //==============================================================================
 void CompensatorAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    if (auto xml = parameters.copyState().createXml())
+        copyXmlToBinary (*xml, destData);
 }
 
 void CompensatorAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    if (auto xml = getXmlFromBinary (data, sizeInBytes))
+        if (xml->hasTagName (parameters.state.getType()))
+            parameters.replaceState (juce::ValueTree::fromXml (*xml));
 }
 
 //==============================================================================
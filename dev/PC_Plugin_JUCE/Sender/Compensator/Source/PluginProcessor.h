@@ -9,11 +9,20 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DelayLine.h"
+#include "DelayLineResizer.h"
+#include "LatencyMeter.h"
+#include "LatencyTracker.h"
+#include "OscScheduler.h"
+#include "ChannelAligner.h"
 
 //==============================================================================
 /**
 */
-class CompensatorAudioProcessor  : public juce::AudioProcessor
+class CompensatorAudioProcessor  : public juce::AudioProcessor,
+                                   private juce::AudioProcessorValueTreeState::Listener,
+                                   private juce::AsyncUpdater,
+                                   private juce::Timer
 {
 public:
     //==============================================================================
@@ -53,20 +62,156 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
+    // "delay" in seconds, shared by the editor, OSC and host automation, and
+    // "maxDelay", the longest delay the ring is sized for
+    juce::AudioProcessorValueTreeState parameters;
     
-    float fLenSec;
+    // bytes of delay memory this instance holds, safe from any thread
+    size_t getMemoryFootprint() const;
+    
+    // sends a probe on the output, listens for it on the "Return" sidechain
+    // and sets the delay to the measured round trip. Not available in PDC mode,
+    // where the output is the return itself
+    void startLatencyMeasurement() { if (! isPdcEnabled()) m_latencyMeter.start(); }
+    const LatencyMeter& getLatencyMeter() const { return m_latencyMeter; }
+    
+    // follows the latency from live audio while "track" is on
+    const LatencyTracker& getLatencyTracker() const { return m_latencyTracker; }
+    
+    // "pdc" on: the plugin sits on the return track, passes it through and
+    // reports the delay as its latency, so the host delays every other track
+    bool isPdcEnabled() const { return *m_pfPdc > 0.5f; }
+    int getReportedLatency() const { return m_iReportedLatency; }
+    
+    // records every input channel and gives each one the extra delay that
+    // lines it up with the latest arriving one, against channel 1
+    void startAlignment() { m_channelAligner.start(); }
+    const ChannelAligner& getChannelAligner() const { return m_channelAligner; }
+    
+    // remote control on OSC port 9001 from the first prepareToPlay on, works with or without the editor
+    const OscControl& getOscControl() const { return m_oscControl; }
+    
+    // "follow" on: path delay reports from the transport ("/vibeio/latency/<feed>",
+    // in seconds) move the delay by as much as the path changed, at most
+    // "followWindow" away from where it was last set by hand, measured or tracked.
+    // Every receiver instance reports under its own feed id, "followFeed" picks one
+    static constexpr int kiMaxFeeds = 16;
+    bool isFollowing() const            { return *m_pfFollow > 0.5f; }
+    int getFollowedFeed() const         { return juce::roundToInt (m_pfFollowFeed->load()) + 1; }
+    float getFollowedLatency() const    { return m_fFollowReport; }
+    
+    // time from an OSC datagram arriving to the start of the block that applies it
+    double getOscLatencyMs() const      { return m_dOscLatencyMs; }
+    double getOscMaxLatencyMs() const   { return m_dOscMaxLatencyMs; }
 
 private:
-    juce::AudioBuffer<float> m_fDelayBuffer;
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    float getDelayInSamples() const;
+    int getMaxDelayInSamples() const;
+    DelayLine::Format getStorageFormat() const { return (DelayLine::Format) juce::roundToInt (m_pfStorage->load()); }
+    
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    
+    // applies a finished measurement or a tracked estimate on the message thread
+    void handleAsyncUpdate() override;
+    void applyLatency (double dLatencySamples);
+    void applyAlignment();
+    void adoptResizedDelayLine();
+    // one block of at most m_iMaxBlockSize samples, channels laid out like the processBlock buffer
+    void processSubBlock (float* const* channels, int numSamples);
+    void applyOscEvents();
+    void applyOscDelay (float fValue);
+    void applyLatencyReport (float fReportSec);
+    bool isLatencySlot (int iSlot) const { return iSlot >= m_iOscLatencySlot && iSlot < m_iOscLatencySlot + kiMaxFeeds; }
+    
+    // announces latency changes to the host, message thread only
+    void timerCallback() override;
+    int getLatencyToReport() const;
+    
+    // delay changes glide over this time instead of jumping the read head
+    static constexpr double kfRampSec = 0.05;
+    
+    // in PDC mode the reported latency is rounded up and the plugin delays the
+    // rest itself. The headroom lets a tracked delay drift this many samples
+    // before the host is told again, and a new value must hold for the settle
+    // time, because most hosts glitch when the latency changes
+    static constexpr int kiPdcHeadroom = 64;
+    static constexpr juce::uint32 kiPdcSettleMs = 1000;
+    
+    // swapped for a bigger one on the audio thread, see DelayLineResizer. A
+    // new line missing more than this many blocks of history is copied again
+    static constexpr int kiMaxCatchUpBlocks = 4;
+    std::unique_ptr<DelayLine> m_delayLine;
+    DelayLineResizer m_resizer;
+    std::atomic<int> m_iLineMaxDelay { 0 };
+    std::atomic<size_t> m_iLineBytes { 0 };
+    // "delay" went past "maxDelay", the message thread raises the maximum to it
+    std::atomic<bool> m_bMaxDelayPending { false };
+    
+    LatencyMeter m_latencyMeter;
+    LatencyTracker m_latencyTracker;
+    std::atomic<bool> m_bMeasurementPending { false };
+    std::atomic<bool> m_bTrackedPending { false };
+    std::atomic<double> m_dTrackedLag { 0.0 };
+    
+    // every channel is delayed by "delay" plus its own "channelDelayN"
+    static constexpr int kiMaxChannels = ChannelAligner::kiMaxChannels;
+    ChannelAligner m_channelAligner;
+    std::atomic<bool> m_bAlignmentPending { false };
+    std::atomic<float>* m_pfChannelDelay[kiMaxChannels] {};
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> m_smoothedChannelDelay[kiMaxChannels];    // in samples
+    juce::HeapBlock<float> m_fChannelRamp;  // per sample delay of one channel
+    
+    // an OSC value drives the delay from the sample its bundle was timed for
+    // until the parameter, synced on the message thread or automated, moves again
+    OscControl m_oscControl;
+    OscScheduler m_oscScheduler;
+    juce::int64 m_iSamplePosition = 0;
+    std::atomic<bool> m_bOscDelayApplied { false };
+    std::atomic<float> m_fOscDelayValue { 0.0f };   // normalised
+    juce::RangedAudioParameter* m_pDelayParameter = nullptr;
+    juce::RangedAudioParameter* m_pOscParameters[OscControl::kiMaxSlots] {};
+    int m_iOscDelaySlot = -1;
+    int m_iOscMeasureSlot = -1;
+    int m_iOscAlignSlot = -1;
+    std::atomic<bool> m_bOscPending { false };
+    std::atomic<bool> m_bOscOverride { false };
+    std::atomic<float> m_fOscDelayTime { 0.0f };
+    float m_fDelayTimeAtOsc = 0.0f;
+    std::atomic<double> m_dOscLatencyMs { 0.0 };
+    std::atomic<double> m_dOscMaxLatencyMs { 0.0 };
+    
+    // the delay and the report it was paired with when it was last set by
+    // anything but a report, every report is applied as a change from there
+    // first of kiMaxFeeds consecutive slots, one per feed id
+    int m_iOscLatencySlot = -1;
+    std::atomic<float>* m_pfFollow = nullptr;
+    std::atomic<float>* m_pfFollowWindow = nullptr;
+    std::atomic<float>* m_pfFollowFeed = nullptr;
+    int m_iFollowAnchorFeed = 0;
+    std::atomic<float> m_fFollowReport { 0.0f };
+    bool m_bFollowAnchored = false;
+    float m_fFollowAnchorDelay = 0.0f;
+    float m_fFollowAnchorReport = 0.0f;
+    float m_fFollowLastSet = 0.0f;
     
-    float m_fLenSec;
-    int m_iLenSample;
-    float m_fBuffLenSec;
-    int m_iBuffLenSample;
+    std::atomic<float>* m_pfDelayTime = nullptr;
+    std::atomic<float>* m_pfMaxDelayTime = nullptr;
+    std::atomic<float>* m_pfPdc = nullptr;
+    std::atomic<float>* m_pfStorage = nullptr;
+    std::atomic<int> m_iReportedLatency { 0 };
+    int m_iPendingLatency = -1;
+    juce::uint32 m_iPendingSinceMs = 0;
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> m_smoothedDelay;  // in samples
+    juce::HeapBlock<float> m_fDelayRamp;    // per sample delay of the current block
+    // the buffer's channels offset to the current sub-block. Wrapping them in an
+    // AudioBuffer would allocate, it only has room for 32 channel pointers
+    juce::HeapBlock<float*> m_pfSubBlockChannels;
+    int m_iSubBlockChannels = 0;
+    int m_iMaxBlockSize = 0;
+    int m_iNumChannels = 0;
     
-    int m_iReadIdx;
-    int m_iWriteIdx;
-    int m_iSampleRate;
+    std::atomic<int> m_iSampleRate { 0 };
     int m_counter = 0;
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompensatorAudioProcessor)
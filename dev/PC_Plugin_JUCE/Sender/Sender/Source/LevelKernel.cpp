@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    LevelKernel.cpp
+
+  ==============================================================================
+*/
+
+#include "LevelKernel.h"
+#include "../../Shared/KernelDispatch.h"
+
+namespace
+{
+    constexpr int kiLanes = 8;
+
+    forcedinline float sumOfSquares (const float* pfSrc, int iNumSamples)
+    {
+        float fSums[kiLanes] = {};
+        const int iVectorised = iNumSamples - iNumSamples % kiLanes;
+
+        for (int i = 0; i < iVectorised; i += kiLanes)
+            for (int j = 0; j < kiLanes; ++j)
+                fSums[j] += pfSrc[i + j] * pfSrc[i + j];
+
+        for (int i = iVectorised; i < iNumSamples; ++i)
+            fSums[0] += pfSrc[i] * pfSrc[i];
+
+        float fSum = 0.0f;
+        for (int j = 0; j < kiLanes; ++j)
+            fSum += fSums[j];
+        return fSum;
+    }
+
+    template <int kiBlock>
+    struct SumOfSquares
+    {
+        static float baseline (const float* pfSrc, int iNumSamples)
+        {
+            return kiBlock > 0 && iNumSamples == kiBlock ? sumOfSquares (pfSrc, kiBlock)
+                                                         : sumOfSquares (pfSrc, iNumSamples);
+        }
+
+       #if KERNEL_DISPATCH_HAS_AVX2
+        // the eight partial sums fill one 256 bit register instead of two SSE ones
+        static KERNEL_DISPATCH_TARGET ("avx2") float avx2 (const float* pfSrc, int iNumSamples)
+        {
+            return kiBlock > 0 && iNumSamples == kiBlock ? sumOfSquares (pfSrc, kiBlock)
+                                                         : sumOfSquares (pfSrc, iNumSamples);
+        }
+       #endif
+    };
+}
+
+LevelKernel::Function LevelKernel::select (int iBlockSize)
+{
+    static const bool bAvx2 = KernelDispatch::canUseAvx2 (false);
+    return KernelDispatch::select<SumOfSquares> (iBlockSize, bAvx2);
+}
@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    LevelKernel.h
+    Sum of squares of a block, for the silence gate in front of the socket.
+
+    A float sum is a dependency chain the compiler will not reorder on its
+    own, so the loop keeps eight partial sums it can put in one SIMD register.
+    Only the tail past the last multiple of eight is summed serially. The
+    variants per block size and for AVX2 are built and picked by
+    KernelDispatch.h, FMA is not needed for a sum of squares.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace LevelKernel
+{
+    using Function = float (*) (const float* pfSrc, int iNumSamples);
+
+    // cheap, but call where the block size is known, prepareToPlay()
+    Function select (int iBlockSize);
+}
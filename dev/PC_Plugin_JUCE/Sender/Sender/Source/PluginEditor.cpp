@@ -18,6 +18,8 @@ SenderAudioProcessorEditor::SenderAudioProcessorEditor (SenderAudioProcessor& p)
     setSize (400, 300);
     labelSampleRate.setText(juce::String(processor.getSampleRate()), juce::dontSendNotification);
     labelChannelNum.setText(juce::String(processor.getTotalNumInputChannels()), juce::dontSendNotification);
+    timerCallback();
+    startTimerHz(2);
 }
 
 SenderAudioProcessorEditor::~SenderAudioProcessorEditor()
@@ -39,6 +41,17 @@ void SenderAudioProcessorEditor::paint (juce::Graphics& g)
     
     addAndMakeVisible(labelChannelNum);
     labelChannelNum.setBounds(10, 40, 100, 30);
+    
+    addAndMakeVisible(labelSocket);
+    labelSocket.setBounds(10, 70, 300, 30);
+}
+
+void SenderAudioProcessorEditor::timerCallback()
+{
+    // the socket is opened with the first prepareToPlay, which may come after the editor
+    const int port = audioProcessor.getSendPort();
+    labelSocket.setText(port >= 0 ? "sending from port " + juce::String(port) : juce::String("socket opens when playback starts"),
+                        juce::dontSendNotification);
 }
 
 void SenderAudioProcessorEditor::resized()
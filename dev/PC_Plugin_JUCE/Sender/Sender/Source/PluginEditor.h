@@ -14,7 +14,8 @@
 //==============================================================================
 /**
 */
-class SenderAudioProcessorEditor  : public juce::AudioProcessorEditor
+class SenderAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                    private juce::Timer
 {
 public:
     SenderAudioProcessorEditor (SenderAudioProcessor&);
@@ -31,6 +32,9 @@ private:
     
     juce::Label labelSampleRate;
     juce::Label labelChannelNum;
+    juce::Label labelSocket;
+    
+    void timerCallback() override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SenderAudioProcessorEditor)
 };
@@ -22,8 +22,6 @@ SenderAudioProcessor::SenderAudioProcessor()
                        )
 #endif
 {
-    // set up the datagramSocket
-    socket.bindToPort(0); // Bind to any available local port
 }
 
 SenderAudioProcessor::~SenderAudioProcessor()
@@ -100,6 +98,15 @@ void SenderAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock
     m_sampleRate = sampleRate;
     m_counter = 0;
     
+    // the audio thread only runs between here and releaseResources, so it never sees the socket change
+    if (socket == nullptr)
+    {
+        socket = std::make_unique<juce::DatagramSocket>();
+        socket->bindToPort(0); // Bind to any available local port
+        m_sendPort = socket->getBoundPort();
+    }
+    m_sumOfSquares = LevelKernel::select (samplesPerBlock);
+    
     angleDelta = (2.0 * juce::MathConstants<double>::pi * frequency) / sampleRate;
 }
 
@@ -159,10 +166,7 @@ void SenderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce:
         float sumOfSquares = 0.0f;
         
         // compute the sum of squares
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            sumOfSquares += channelData[sample] * channelData[sample];
-        }
+        sumOfSquares = m_sumOfSquares (channelData, buffer.getNumSamples());
         
         // Compute RMS for this channel
         rms = std::sqrt(sumOfSquares / buffer.getNumSamples());
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "LevelKernel.h"
 
 //==============================================================================
 /**
@@ -55,17 +56,25 @@ public:
     
     void sendAudioData (const float* data, int numSamples)
     {
-        juce::MemoryBlock memoryBlock(data, sizeof(float) * numSamples);
-        socket.write("127.0.0.1", 41234, memoryBlock.getData(), memoryBlock.getSize());
+        if (socket != nullptr)
+            socket->write("127.0.0.1", 41234, data, (int) sizeof(float) * numSamples);
     }
     
     float getSampleRate() const { return m_sampleRate; }
+    
+    // local port the audio goes out from, -1 until the first prepareToPlay opened the socket
+    int getSendPort() const { return m_sendPort; }
 
 private:
-    juce::DatagramSocket socket;
+    // opened on the first prepareToPlay, so plugin scans do not open one per instance
+    std::unique_ptr<juce::DatagramSocket> socket;
+    std::atomic<int> m_sendPort { -1 };
     int m_counter;
     double m_sampleRate;
     
+    // for the host's block size and this CPU, picked in prepareToPlay
+    LevelKernel::Function m_sumOfSquares = LevelKernel::select (0);
+    
     double currentAngle = 0.0;
     double frequency = 440.0;
     double angleDelta = 0.0;
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.h
+    Block size and instruction set dispatch for the small kernels of the
+    plugins in this folder, the Compensator's FirKernel and the Sender's
+    LevelKernel.
+
+    A kernel is a class template over the block size with a static baseline()
+    and, where KERNEL_DISPATCH_HAS_AVX2 is set, a static avx2() marked with
+    KERNEL_DISPATCH_TARGET. Both wrap the same inlined loop, which gets a
+    constant trip count when the block is kiBlock long. select() instantiates
+    the kernel for each common host block size and returns the variant for the
+    size and the CPU, kiBlock 0 stands for any other length.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// GCC and clang build single functions for an instruction set the rest of
+// the plugin does not assume, MSVC has no equivalent
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG)
+ #define KERNEL_DISPATCH_HAS_AVX2 1
+ #define KERNEL_DISPATCH_TARGET(isa) __attribute__ ((target (isa)))
+#else
+ #define KERNEL_DISPATCH_HAS_AVX2 0
+#endif
+
+namespace KernelDispatch
+{
+    // whether avx2() variants may run here, checked once per kernel by its caller
+    inline bool canUseAvx2 (bool bNeedsFma)
+    {
+       #if KERNEL_DISPATCH_HAS_AVX2
+        return juce::SystemStats::hasAVX2() && (! bNeedsFma || juce::SystemStats::hasFMA3());
+       #else
+        juce::ignoreUnused (bNeedsFma);
+        return false;
+       #endif
+    }
+
+    template <template <int> class Kernel, int kiBlock>
+    auto pick (bool bAvx2)
+    {
+       #if KERNEL_DISPATCH_HAS_AVX2
+        if (bAvx2)
+            return &Kernel<kiBlock>::avx2;
+       #else
+        juce::ignoreUnused (bAvx2);
+       #endif
+        return &Kernel<kiBlock>::baseline;
+    }
+
+    template <template <int> class Kernel>
+    auto select (int iBlockSize, bool bAvx2)
+    {
+        switch (iBlockSize)
+        {
+            case 32:   return pick<Kernel, 32> (bAvx2);
+            case 64:   return pick<Kernel, 64> (bAvx2);
+            case 128:  return pick<Kernel, 128> (bAvx2);
+            case 256:  return pick<Kernel, 256> (bAvx2);
+            case 512:  return pick<Kernel, 512> (bAvx2);
+            case 1024: return pick<Kernel, 1024> (bAvx2);
+            default:   return pick<Kernel, 0> (bAvx2);
+        }
+    }
+}